@@ -0,0 +1,199 @@
+// MIT License
+
+// Copyright (c) 2021 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "api.h"
+#include "netplay.h"
+#include "replay.h"
+#include "tools.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// two sessions over the loopback transport in one process, the second one
+// falls behind and catches up, so the first plays ahead and rolls back,
+// at the end both machines have to be the same
+
+#define PLAYERS 2
+#define DELAY 2
+#define MAX_STEPS 100000
+
+typedef struct
+{
+    tic80* product;
+    tic_netplay* session;
+    tic_tick_data tickData;
+    s32 rollbacks;
+} Peer;
+
+static u64 getCounter(void* data)
+{
+    return clock();
+}
+
+static u64 getFreq(void* data)
+{
+    return CLOCKS_PER_SEC;
+}
+
+static void onTrace(void* data, const char* text, u8 color) {}
+
+static void onError(void* data, const char* info)
+{
+    fprintf(stderr, "error: %s\n", info);
+}
+
+static void onExit(void* data) {}
+
+// the same as the studio does for a netplay frame
+static void tick(void* data, tic80_gamepads gamepads, bool hidden)
+{
+    Peer* peer = data;
+    tic_mem* tic = (tic_mem*)peer->product;
+    tic80_input* input = &tic->ram->input;
+
+    input->gamepads = gamepads;
+    ZEROMEM(input->mouse);
+    ZEROMEM(input->keyboard);
+
+    tic_core_tick_start(tic);
+    tic_core_tick(tic, &peer->tickData);
+    tic_core_tick_end(tic);
+
+    if(hidden)
+        tic_core_blit_skip(tic);
+    else
+        tic_core_blit(tic);
+}
+
+// buttons change every few frames and are released after the last input frame,
+// so the guesses past it are right and the last frames need no rollback
+static tic80_gamepad pressed(s32 player, u32 frame, u32 frames)
+{
+    u32 hash = (frame / 3 + 1) * 2654435761u;
+    return (tic80_gamepad){.data = frame < frames ? (u8)(hash >> (player * 8 + 8)) : 0};
+}
+
+static void step(Peer* peer, s32 player, u32 frames, u32 end)
+{
+    tic_mem* tic = (tic_mem*)peer->product;
+    tic_netplay* session = peer->session;
+    u32 frame = tic_netplay_frame(session);
+
+    if(tic_netplay_input(session, pressed(player, frame + DELAY, frames)) && frame < end)
+    {
+        if(frame == 0)
+        {
+            u32 seed = tic_netplay_seed(session);
+
+            tic_core_seed(tic, seed);
+            peer->tickData.clock = (tic80_clock){.mode = TIC80_CLOCK_FRAMES, .tstamp = (s32)seed};
+        }
+
+        peer->rollbacks += tic_netplay_advance(session, tic, tick, peer);
+    }
+}
+
+s32 main(s32 argc, char** argv)
+{
+    if(argc < 2)
+    {
+        printf("usage: tic80-netplay <cart> [frames]\n");
+        return 1;
+    }
+
+    u32 frames = argc >= 3 ? atoi(argv[2]) : 600;
+    // past the last input by more than the frames played ahead, all of them confirmed
+    u32 end = frames + DELAY + TIC_NETPLAY_WINDOW + 1;
+
+    s32 cartSize = 0;
+    const void* cart = tic_tool_map(argv[1], &cartSize);
+
+    if(!cart)
+    {
+        fprintf(stderr, "error: can't open %s\n", argv[1]);
+        return 1;
+    }
+
+    tic_netplay_loopback* loopback = tic_netplay_loopback_create(PLAYERS);
+    Peer peers[PLAYERS] = {0};
+
+    for(s32 p = 0; p < PLAYERS; p++)
+    {
+        Peer* peer = &peers[p];
+        peer->product = tic80_create(TIC80_SAMPLERATE, TIC80_PIXEL_COLOR_RGBA8888);
+        tic80_load(peer->product, (void*)cart, cartSize);
+
+        tic_mem* tic = (tic_mem*)peer->product;
+        peer->session = tic_netplay_create(PLAYERS, p, DELAY, tic_replay_cart(tic->cart),
+            tic_netplay_loopback_transport(loopback, p));
+
+        peer->tickData = (tic_tick_data)
+        {
+            .error = onError,
+            .trace = onTrace,
+            .exit = onExit,
+            .counter = getCounter,
+            .freq = getFreq,
+        };
+    }
+
+    tic_tool_unmap(cart, cartSize);
+
+    s32 steps = 0;
+
+    for(; steps < MAX_STEPS; steps++)
+    {
+        if(tic_netplay_frame(peers[0].session) == end
+            && tic_netplay_frame(peers[1].session) == end)
+            break;
+
+        step(&peers[0], 0, frames, end);
+
+        // the second peer runs at two thirds of the speed in the first half
+        if(steps % 3 || tic_netplay_frame(peers[1].session) > frames / 2)
+            step(&peers[1], 1, frames, end);
+    }
+
+    u64 hashes[PLAYERS];
+
+    for(s32 p = 0; p < PLAYERS; p++)
+        hashes[p] = tic_replay_hash((tic_mem*)peers[p].product);
+
+    bool same = steps < MAX_STEPS && hashes[0] == hashes[1];
+
+    if(steps == MAX_STEPS)
+        printf("the sessions stalled at frames %u and %u\n",
+            tic_netplay_frame(peers[0].session), tic_netplay_frame(peers[1].session));
+    else
+        printf("%u frames, %i and %i played again, the machines %s\n",
+            end, peers[0].rollbacks, peers[1].rollbacks, same ? "match" : "differ");
+
+    for(s32 p = 0; p < PLAYERS; p++)
+    {
+        tic_netplay_close(peers[p].session);
+        tic80_delete(peers[p].product);
+    }
+
+    return same ? 0 : 1;
+}
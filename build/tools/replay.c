@@ -0,0 +1,152 @@
+// MIT License
+
+// Copyright (c) 2021 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "api.h"
+#include "replay.h"
+#include "tools.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static u64 getCounter(void* data)
+{
+    return clock();
+}
+
+static u64 getFreq(void* data)
+{
+    return CLOCKS_PER_SEC;
+}
+
+static void onTrace(void* data, const char* text, u8 color) {}
+
+static void onError(void* data, const char* info)
+{
+    fprintf(stderr, "error: %s\n", info);
+}
+
+static void onExit(void* data) {}
+
+s32 main(s32 argc, char** argv)
+{
+    bool verify = argc >= 4 && strcmp(argv[3], "--verify") == 0;
+
+    if(argc < 3 || (argc >= 4 && !verify))
+    {
+        printf("usage: tic80-replay <cart> <replay" TIC_REPLAY_EXT "> [--verify]\n");
+        return 1;
+    }
+
+    s32 cartSize = 0;
+    const void* cart = tic_tool_map(argv[1], &cartSize);
+
+    if(!cart)
+    {
+        fprintf(stderr, "error: can't open %s\n", argv[1]);
+        return 1;
+    }
+
+    tic_replay* replay = NULL;
+
+    {
+        s32 size = 0;
+        const void* data = tic_tool_map(argv[2], &size);
+
+        if(data)
+        {
+            replay = tic_replay_load(data, size);
+            tic_tool_unmap(data, size);
+        }
+    }
+
+    if(!replay)
+    {
+        fprintf(stderr, "error: can't read %s\n", argv[2]);
+        return 1;
+    }
+
+    tic80* product = tic80_create(TIC80_SAMPLERATE, TIC80_PIXEL_COLOR_RGBA8888);
+    tic_mem* tic = (tic_mem*)product;
+
+    tic80_load(product, (void*)cart, cartSize);
+    tic_tool_unmap(cart, cartSize);
+
+    const tic_replay_header* header = tic_replay_info(replay);
+
+    if(header->cart != tic_replay_cart(tic->cart))
+        fprintf(stderr, "warning: the replay was recorded with another version of the cart\n");
+
+    tic->ram->persistent = header->persistent;
+    tic_core_seed(tic, header->seed);
+
+    tic_tick_data tickData =
+    {
+        .error = onError,
+        .trace = onTrace,
+        .exit = onExit,
+        .counter = getCounter,
+        .freq = getFreq,
+    };
+
+    s32 count = tic_replay_count(replay);
+    s32 failed = -1;
+    u64 start = getCounter(NULL);
+
+    for(s32 i = 0; i < count; i++)
+    {
+        const tic_replay_frame* frame = tic_replay_get(replay, i);
+
+        // the same as the studio does before every frame
+        tic->ram->input = frame->input;
+        tic->ram->mapping = header->mapping;
+        tic->ram->vram.vars.cursor.sprite = tic_cursor_arrow;
+        tic->ram->vram.vars.cursor.system = true;
+
+        tic_replay_clock(&tickData, frame);
+
+        tic_core_tick_start(tic);
+        tic_core_tick(tic, &tickData);
+
+        if(verify && tic_replay_hash(tic) != frame->hash)
+        {
+            failed = i;
+            break;
+        }
+
+        tic_core_tick_end(tic);
+        tic_core_blit(tic);
+    }
+
+    double elapsed = (double)(getCounter(NULL) - start) * 1000.0 / getFreq(NULL);
+
+    if(failed >= 0)
+        printf("replay diverged at frame %i of %i\n", failed, count);
+    else
+        printf("%i frames in %.1f ms, %.3f ms per frame\n", count, elapsed, count ? elapsed / count : 0.0);
+
+    tic80_delete(product);
+    tic_replay_close(replay);
+
+    return failed >= 0 ? 1 : 0;
+}
@@ -35,26 +35,6 @@ typedef struct
     u8* data;
 } FileBuffer;
 
-static FileBuffer readFile(const char* path)
-{
-    FileBuffer buffer = {0};
-
-    FILE* file = fopen(path, "rb");
-    if(file)
-    {
-
-        fseek(file, 0, SEEK_END);
-        buffer.size = ftell(file);
-        fseek(file, 0, SEEK_SET);
-
-        if((buffer.data = malloc(buffer.size)) && fread(buffer.data, buffer.size, 1, file)) {}
-
-        fclose(file);
-    }
-
-    return buffer;
-}
-
 static bool writeFile(const char* name, FileBuffer buffer)
 {
     FILE* file = fopen(name, "wb");
@@ -74,14 +54,15 @@ s32 main(s32 argc, char** argv)
 {
     if(argc >= 2)
     {
-        FileBuffer buffer = readFile(argv[1]);
+        s32 size = 0;
+        const void* data = tic_tool_map(argv[1], &size);
 
-        if(buffer.data)
+        if(data)
         {
             tic_cartridge* cart = malloc(sizeof(tic_cartridge));
 
-            tic_cart_load(cart, buffer.data, buffer.size);
-            free(buffer.data);
+            tic_cart_load(cart, data, size);
+            tic_tool_unmap(data, size);
 
             // export cover.png
             {
@@ -22,6 +22,8 @@ set(TIC80CORE_SRC
     ${TIC80CORE_DIR}/core/sound.c
     ${TIC80CORE_DIR}/tic.c
     ${TIC80CORE_DIR}/cart.c
+    ${TIC80CORE_DIR}/replay.c
+    ${TIC80CORE_DIR}/netplay.c
     ${TIC80CORE_DIR}/tools.c
     ${TIC80CORE_DIR}/zip.c
     ${TIC80CORE_DIR}/tilesheet.c
@@ -36,6 +38,11 @@ if(BUILD_DEPRECATED)
     set(TIC80CORE_SRC ${TIC80CORE_SRC} ${TIC80CORE_DIR}/ext/gif.c)
 endif()
 
+if(NOT (EMSCRIPTEN OR NINTENDO_3DS OR BAREMETALPI))
+    set(BUILD_NETPLAY_UDP TRUE)
+    set(TIC80CORE_SRC ${TIC80CORE_SRC} ${TIC80CORE_DIR}/netplay_udp.c)
+endif()
+
 add_library(tic80core STATIC ${TIC80CORE_SRC})
 
 if (FREEBSD)
@@ -47,6 +54,14 @@ if(WIN32)
     target_link_libraries(tic80core PUBLIC dlfcn)
 endif()
 
+if(BUILD_NETPLAY_UDP)
+    target_compile_definitions(tic80core PUBLIC TIC80_NETPLAY_UDP)
+
+    if(WIN32)
+        target_link_libraries(tic80core PUBLIC ws2_32)
+    endif()
+endif()
+
 target_include_directories(tic80core
     PRIVATE
         ${THIRDPARTY_DIR}/moonscript
@@ -117,6 +132,9 @@ if(BUILD_STATIC)
 
 endif()
 
+set(VM_MEMORY_LIMIT 67108864 CACHE STRING "Max memory a cart script VM can allocate, in bytes")
+target_compile_definitions(tic80core PRIVATE TIC_VM_MEMORY_LIMIT=${VM_MEMORY_LIMIT})
+
 if(BUILD_DEPRECATED)
     target_compile_definitions(tic80core PRIVATE BUILD_DEPRECATED)
     target_link_libraries(tic80core PRIVATE giflib)
@@ -76,6 +76,7 @@ if(BUILD_WITH_JS)
     endif()
 
     target_link_libraries(js PRIVATE runtime)
+    target_compile_definitions(js PRIVATE QUICKJS_VERSION="${CONFIG_VERSION}")
 
     target_link_libraries(js PRIVATE quickjs)
     target_include_directories(js
@@ -11,6 +11,8 @@ set(TIC80STUDIO_SRC
     ${TIC80LIB_DIR}/studio/studio.c
     ${TIC80LIB_DIR}/studio/config.c
     ${TIC80LIB_DIR}/studio/fs.c
+    ${TIC80LIB_DIR}/studio/cache.c
+    ${TIC80LIB_DIR}/studio/rewind.c
     ${TIC80LIB_DIR}/ext/md5.c
     ${TIC80LIB_DIR}/ext/json.c
     ${TIC80LIB_DIR}/ext/png.c
@@ -1,5 +1,5 @@
 ################################
-# bin2txt cart2prj prj2cart xplode wasmp2cart
+# bin2txt cart2prj prj2cart xplode wasmp2cart tic80-replay tic80-netplay
 ################################
 
 if(BUILD_TOOLS)
@@ -33,4 +33,12 @@ if(BUILD_TOOLS)
         target_link_libraries(xplode m)
     endif()
 
+    add_executable(tic80-replay ${TOOLS_DIR}/replay.c)
+    target_include_directories(tic80-replay PRIVATE ${CMAKE_SOURCE_DIR}/src ${CMAKE_SOURCE_DIR}/include)
+    target_link_libraries(tic80-replay tic80core)
+
+    add_executable(tic80-netplay ${TOOLS_DIR}/netplay.c)
+    target_include_directories(tic80-netplay PRIVATE ${CMAKE_SOURCE_DIR}/src ${CMAKE_SOURCE_DIR}/include)
+    target_link_libraries(tic80-netplay tic80core)
+
 endif()
\ No newline at end of file
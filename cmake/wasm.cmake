@@ -5,6 +5,9 @@
 option(BUILD_WITH_WASM "Wasm Enabled" ${BUILD_WITH_ALL})
 message("BUILD_WITH_WASM: ${BUILD_WITH_WASM}")
 
+set(WASM_MAX_PAGE_COUNT 256 CACHE STRING "Max WASM linear memory size in 64K pages")
+option(WASM_EAGER_COMPILE "Compile all WASM functions at load instead of on the first call" OFF)
+
 if(BUILD_WITH_WASM AND PREFER_SYSTEM_LIBRARIES)
     find_path(wasm_INCLUDE_DIR NAMES wasm3.h)
     find_library(wasm_LIBRARY NAMES m3)
@@ -14,6 +17,7 @@ if(BUILD_WITH_WASM AND PREFER_SYSTEM_LIBRARIES)
         )
         target_compile_definitions(wasm INTERFACE TIC_BUILD_WITH_WASM)
         target_link_libraries(wasm PRIVATE runtime ${wasm_LIBRARY})
+        target_compile_definitions(wasm PRIVATE TIC_WASM_MAX_PAGE_COUNT=${WASM_MAX_PAGE_COUNT})
         target_include_directories(wasm
             PUBLIC ${wasm_INCLUDE_DIR}
             PRIVATE
@@ -60,6 +64,11 @@ if(BUILD_WITH_WASM)
     endif()
 
     target_link_libraries(wasm PRIVATE runtime)
+    target_compile_definitions(wasm PRIVATE TIC_WASM_MAX_PAGE_COUNT=${WASM_MAX_PAGE_COUNT})
+
+    if(WASM_EAGER_COMPILE)
+        target_compile_definitions(wasm PRIVATE TIC_WASM_EAGER_COMPILE)
+    endif()
 
     target_include_directories(wasm
         PUBLIC ${WASM_DIR}
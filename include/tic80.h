@@ -184,10 +184,34 @@ typedef struct
 
 } tic80_input;
 
+typedef enum
+{
+    TIC80_CLOCK_REAL,   // host counter and system time
+    TIC80_CLOCK_FRAMES, // 1000/60 ms per frame, the same results at any speed
+    TIC80_CLOCK_HOST,   // time and tstamp from the host
+} tic80_clock_mode;
+
+typedef struct
+{
+    tic80_clock_mode mode;
+    double time;    // ms, for the host clock
+    s32 tstamp;     // for the host clock, the frames clock counts from it
+} tic80_clock;
+
 TIC80_API tic80* tic80_create(s32 samplerate, tic80_pixel_color_format format);
 TIC80_API void tic80_load(tic80* tic, void* cart, s32 size);
 TIC80_API void tic80_tick(tic80* tic, tic80_input input, u64 (*counter)(), u64 (*freq)());
+TIC80_API void tic80_tick_clock(tic80* tic, tic80_input input, u64 (*counter)(), u64 (*freq)(), const tic80_clock* clock);
+// runs a frame that won't be shown, the screen buffer is left as it was
+TIC80_API void tic80_tick_hidden(tic80* tic, tic80_input input, u64 (*counter)(), u64 (*freq)(), const tic80_clock* clock);
+// only draws the screen if the frame changed, false if the screen buffer already holds it
+TIC80_API bool tic80_tick_cached(tic80* tic, tic80_input input, u64 (*counter)(), u64 (*freq)(), const tic80_clock* clock);
 TIC80_API void tic80_sound(tic80* tic);
+
+// machine state of the running cart, the size is 0 if its runtime can't be saved
+TIC80_API s32 tic80_state_size(tic80* tic);
+TIC80_API bool tic80_state_save(tic80* tic, void* buffer, s32 size);
+TIC80_API bool tic80_state_load(tic80* tic, const void* buffer, s32 size);
 TIC80_API void tic80_delete(tic80* tic);
 
 #ifdef __cplusplus
@@ -34,6 +34,8 @@ typedef void(*ErrorOutput)(void*, const char*);
 typedef void(*ExitCallback)(void*);
 typedef u64(*CounterCallback)(void*);
 typedef u64(*FreqCallback)(void*);
+typedef void*(*CacheLoadCallback)(void*, const char* key, s32* size);
+typedef void(*CacheSaveCallback)(void*, const char* key, const void* buffer, s32 size);
 
 typedef struct
 {
@@ -45,9 +47,32 @@ typedef struct
     FreqCallback freq;
     u64 start;
 
+    // optional persistent storage for compiled script bytecode
+    struct
+    {
+        CacheLoadCallback load;
+        CacheSaveCallback save;
+    } cache;
+
+    // what time() and tstamp() return, the real clock by default
+    tic80_clock clock;
+
     void* data;
 } tic_tick_data;
 
+typedef struct
+{
+    s32 heap;       // script heap size in bytes
+    double time;    // time spent in the collector in ms
+} tic_gc_stats;
+
+typedef struct
+{
+    s32 used;       // bytes allocated by the script VM
+    s32 peak;       // max used since the VM was created
+    s32 limit;      // allocations over the limit fail
+} tic_vm_memory;
+
 typedef struct tic_mem tic_mem;
 typedef void(*tic_tick)(tic_mem* memory);
 typedef void(*tic_boot)(tic_mem* memory);
@@ -842,9 +867,10 @@ struct tic_mem
 {
     tic80           product;
     tic_ram*        ram;
-    tic_cartridge   cart;
 
-    tic_ram*        base_ram;
+    // shared between instances loaded from the same data,
+    // use tic_core_cart_own() before writing to it
+    tic_cartridge*  cart;
 
     char saveid[TIC_SAVEID_SIZE];
 
@@ -871,13 +897,29 @@ struct tic_mem
 
 tic_mem* tic_core_create(s32 samplerate, tic80_pixel_color_format format);
 void tic_core_close(tic_mem* memory);
+void tic_core_cart_share(tic_mem* memory, const void* data, s32 size);
+// hosts running instances on several threads have to give the shared carts a lock
+void tic_core_cart_lock(void* data, void (*lock)(void*), void (*unlock)(void*));
+tic_cartridge* tic_core_cart_own(tic_mem* memory);
+// seed the random generators of the cart, a VM started later
+// picks the seed up at init, before the cart code runs
+void tic_core_seed(tic_mem* memory, u32 seed);
 void tic_core_pause(tic_mem* memory);
 void tic_core_resume(tic_mem* memory);
+s32 tic_core_state_size(tic_mem* memory);
+bool tic_core_state_save(tic_mem* memory, void* buffer, s32 size);
+bool tic_core_state_load(tic_mem* memory, const void* buffer, s32 size);
 void tic_core_tick_start(tic_mem* memory);
 void tic_core_tick(tic_mem* memory, tic_tick_data* data);
 void tic_core_tick_end(tic_mem* memory);
+tic_gc_stats tic_core_gc(tic_mem* memory, double budget);
+tic_vm_memory tic_core_vm_memory(tic_mem* memory);
+void tic_core_vm_limit(tic_mem* memory, s32 limit);
 void tic_core_synth_sound(tic_mem* tic);
 void tic_core_blit(tic_mem* tic);
+void tic_core_blit_skip(tic_mem* tic);
+// false if the screen buffer already holds the frame
+bool tic_core_blit_cached(tic_mem* tic);
 void tic_core_blit_ex(tic_mem* tic, tic_blit_callback clb);
 
 #define VBANK(tic, bank)                                \
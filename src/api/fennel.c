@@ -39,29 +39,58 @@ static const char* execute_fennel_src = FENNEL_CODE(
   if(not ok) then return msg end
 );
 
-static bool initFennel(tic_mem* tic, const char* code)
+static const char* compile_fennel_src = FENNEL_CODE(
+  io = { read = true }
+  local fennel = require("fennel")
+  local opts = {allowedGlobals = false, filename="game.fnl"}
+  local src, api = ...
+  if(src:find("\n;; +strict: *true")) then
+    opts.allowedGlobals = api
+    for name in pairs(_G) do table.insert(api, name) end
+  end
+  return fennel.compileString(src, opts)
+);
+
+static bool openFennel(lua_State* fennel)
 {
-    tic_core* core = (tic_core*)tic;
-    luaapi_close(tic);
+    lua_settop(fennel, 0);
+
+    if (luaL_loadbuffer(fennel, (const char *)loadfennel_lua,
+                        loadfennel_lua_len, "fennel.lua") != LUA_OK)
+        return false;
 
-    lua_State* lua = core->currentVM = luaL_newstate();
+    lua_call(fennel, 0, 0);
+
+    return true;
+}
+
+static bool initFennelState(tic_core* core)
+{
+    luaapi_close((tic_mem*)core);
+
+    lua_State* lua = core->currentVM = luaapi_newstate(core);
     luaapi_open(lua);
 
     luaapi_init(core);
 
+    if (!openFennel(lua))
     {
-        lua_State* fennel = core->currentVM;
+        core->data->error(core->data->data, "failed to load fennel compiler");
+        return false;
+    }
 
-        lua_settop(fennel, 0);
+    return true;
+}
 
-        if (luaL_loadbuffer(fennel, (const char *)loadfennel_lua,
-                            loadfennel_lua_len, "fennel.lua") != LUA_OK)
-        {
-            core->data->error(core->data->data, "failed to load fennel compiler");
-            return false;
-        }
+static bool initFennel(tic_mem* tic, const char* code)
+{
+    tic_core* core = (tic_core*)tic;
 
-        lua_call(fennel, 0, 0);
+    if (!initFennelState(core))
+        return false;
+
+    {
+        lua_State* fennel = core->currentVM;
 
         if (luaL_loadbuffer(fennel, execute_fennel_src, strlen(execute_fennel_src), "execute_fennel") != LUA_OK)
         {
@@ -83,6 +112,56 @@ static bool initFennel(tic_mem* tic, const char* code)
     return true;
 }
 
+static void* compileFennel(tic_mem* tic, const char* code, s32* size)
+{
+    void* buffer = NULL;
+    lua_State* fennel = luaapi_newstate((tic_core*)tic);
+
+    if (!fennel)
+        return NULL;
+
+    luaapi_open(fennel);
+
+    if (openFennel(fennel)
+        && luaL_loadbuffer(fennel, compile_fennel_src, strlen(compile_fennel_src), "compile_fennel") == LUA_OK)
+    {
+        lua_pushstring(fennel, code);
+
+        // the API isn't registered in the compiler state,
+        // but strict carts must see its globals as declared
+        luaapi_names(fennel);
+
+        if (lua_pcall(fennel, 2, 1, 0) == LUA_OK && lua_isstring(fennel, -1))
+        {
+            size_t len = 0;
+            const char* lua = lua_tolstring(fennel, -1, &len);
+
+            if (luaL_loadbuffer(fennel, lua, len, "@game.fnl") == LUA_OK)
+                buffer = luaapi_dump(fennel, size);
+        }
+    }
+
+    lua_close(fennel);
+
+    return buffer;
+}
+
+static bool loadFennel(tic_mem* tic, const void* buffer, s32 size)
+{
+    tic_core* core = (tic_core*)tic;
+
+    if (!initFennelState(core))
+        return false;
+
+    {
+        // keep the error handling of the fennel.eval path
+        lua_State* fennel = core->currentVM;
+        luaL_dostring(fennel, "debug.traceback = require('fennel').traceback");
+    }
+
+    return luaapi_load(core, buffer, size);
+}
+
 static const char* const FennelKeywords [] =
 {
     "#", "%", "*", "+", "-", "->", "->>", "-?>", "-?>>", ".", "..", "/",
@@ -232,4 +311,19 @@ TIC_EXPORT const tic_script EXPORT_SCRIPT(Fennel) =
     .useStructuredEdition = true,
 
     .demo = {DemoRom, sizeof DemoRom},
+
+    .bytecode =
+    {
+        .version        = LUA_RELEASE,
+        .compile        = compileFennel,
+        .load           = loadFennel,
+    },
+
+    .gc =
+    {
+        .step           = luaapi_gc_step,
+        .heap           = luaapi_gc_heap,
+    },
+
+    .seed               = luaapi_seed,
 };
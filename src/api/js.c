@@ -28,6 +28,10 @@
 #include <string.h>
 #include <quickjs.h>
 
+#if !defined(QUICKJS_VERSION)
+#define QUICKJS_VERSION NULL
+#endif
+
 extern bool parse_note(const char* noteStr, s32* note, s32* octave);
 
 static inline tic_core* getCore(JSContext *ctx)
@@ -117,13 +121,35 @@ static void closeJavascript(tic_mem* tic)
 
     if(ctx)
     {
-        JSRuntime *rt = JS_GetRuntime(ctx);
-        JS_FreeContext(ctx);
-        JS_FreeRuntime(rt);
+        // the runtime lives in the arena, it's dropped without walking it
+        core->arena.release(tic);
         core->currentVM = NULL;
     }
 }
 
+static void* js_arena_malloc(JSMallocState* s, size_t size)
+{
+    return tic_vm_realloc(s->opaque, NULL, size);
+}
+
+static void js_arena_free(JSMallocState* s, void* ptr)
+{
+    tic_vm_realloc(s->opaque, ptr, 0);
+}
+
+static void* js_arena_realloc(JSMallocState* s, void* ptr, size_t size)
+{
+    return tic_vm_realloc(s->opaque, ptr, size);
+}
+
+static const JSMallocFunctions ArenaMallocFunctions =
+{
+    js_arena_malloc,
+    js_arena_free,
+    js_arena_realloc,
+    tic_vm_block_size,
+};
+
 static JSValue js_print(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv)
 {
     tic_core* core = getCore(ctx); tic_mem* tic = (tic_mem*)core;
@@ -1032,14 +1058,55 @@ static JSValue js_ffts(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueC
     return JS_NewFloat64(ctx, core->api.ffts(tic, start_freq, end_freq));
 }
 
-static bool initJavascript(tic_mem* tic, const char* code)
+// QuickJS seeds Math.random from the clock and can't be reseeded,
+// so a seeded VM gets its own splitmix64 generator
+static JSValue js_seededRandom(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv, s32 magic, JSValue *data)
+{
+    size_t size = 0;
+    u8* ptr = JS_GetArrayBuffer(ctx, &size, data[0]);
+
+    u64 state;
+    memcpy(&state, ptr, sizeof state);
+
+    u64 z = state += 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    z ^= z >> 31;
+
+    memcpy(ptr, &state, sizeof state);
+
+    return JS_NewFloat64(ctx, (double)(z >> 11) / (double)(1ull << 53));
+}
+
+static void seedJavascript(tic_mem* tic, u32 seed)
+{
+    JSContext* ctx = ((tic_core*)tic)->currentVM;
+
+    u64 state = seed;
+    JSValue data = JS_NewArrayBufferCopy(ctx, (const u8*)&state, sizeof state);
+    JSValue random = JS_NewCFunctionData(ctx, js_seededRandom, 0, 0, 1, &data);
+    JS_FreeValue(ctx, data);
+
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue math = JS_GetPropertyStr(ctx, global, "Math");
+
+    if(JS_IsObject(math))
+        JS_SetPropertyStr(ctx, math, "random", random);
+    else
+        JS_FreeValue(ctx, random);
+
+    JS_FreeValue(ctx, math);
+    JS_FreeValue(ctx, global);
+}
+
+static JSContext* initJavascriptContext(tic_mem* tic)
 {
     closeJavascript(tic);
 
-    JSRuntime *rt = JS_NewRuntime();
+    tic_core* core = (tic_core*)tic;
+    JSRuntime *rt = JS_NewRuntime2(&ArenaMallocFunctions, core);
     JSContext* ctx = JS_NewContext(rt);
 
-    tic_core* core = (tic_core*)tic;
     core->currentVM = ctx;
     JS_SetContextOpaque(ctx, core);
 
@@ -1060,6 +1127,16 @@ static bool initJavascript(tic_mem* tic, const char* code)
         JS_FreeValue(ctx, global);
     }
 
+    if(core->seed.set)
+        seedJavascript(tic, core->seed.value);
+
+    return ctx;
+}
+
+static bool initJavascript(tic_mem* tic, const char* code)
+{
+    JSContext* ctx = initJavascriptContext(tic);
+
     JSValue ret = JS_Eval(ctx, code, strlen(code), "index.js", JS_EVAL_TYPE_GLOBAL);
     if (JS_IsException(ret))
     {
@@ -1072,6 +1149,79 @@ static bool initJavascript(tic_mem* tic, const char* code)
     return true;
 }
 
+static void* compileJavascript(tic_mem* tic, const char* code, s32* size)
+{
+    void* buffer = NULL;
+
+    JSRuntime *rt = JS_NewRuntime2(&ArenaMallocFunctions, (tic_core*)tic);
+    JSContext* ctx = rt ? JS_NewContext(rt) : NULL;
+
+    if (!ctx)
+    {
+        if (rt)
+            JS_FreeRuntime(rt);
+
+        return NULL;
+    }
+
+    JSValue obj = JS_Eval(ctx, code, strlen(code), "index.js", JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY);
+    if (!JS_IsException(obj))
+    {
+        size_t len = 0;
+        u8* data = JS_WriteObject(ctx, &len, obj, JS_WRITE_OBJ_BYTECODE);
+
+        if (data)
+        {
+            buffer = malloc(len);
+            memcpy(buffer, data, len);
+            *size = (s32)len;
+            js_free(ctx, data);
+        }
+
+        JS_FreeValue(ctx, obj);
+    }
+
+    JS_FreeContext(ctx);
+    JS_FreeRuntime(rt);
+
+    return buffer;
+}
+
+static bool loadJavascript(tic_mem* tic, const void* buffer, s32 size)
+{
+    JSContext* ctx = initJavascriptContext(tic);
+
+    JSValue obj = JS_ReadObject(ctx, buffer, size, JS_READ_OBJ_BYTECODE);
+    if (JS_IsException(obj))
+    {
+        js_std_dump_error(ctx);
+        return false;
+    }
+
+    JSValue ret = JS_EvalFunction(ctx, obj);
+    if (JS_IsException(ret))
+    {
+        js_std_dump_error(ctx);
+        return false;
+    }
+    else
+        JS_FreeValue(ctx, ret);
+
+    return true;
+}
+
+static bool gcStepJavascript(tic_mem* tic)
+{
+    tic_core* core = (tic_core*)tic;
+
+    // QuickJS frees most objects by refcount, the collector only looks
+    // for cycles and runs in one go, tic_core_gc doesn't start it
+    // when the previous run doesn't fit in the time left
+    JS_RunGC(JS_GetRuntime(core->currentVM));
+
+    return true;
+}
+
 static bool callFunc1(JSContext* ctx, JSValue func, JSValue this_val, JSValue value)
 {
     JSValue ret = JS_Call(ctx, func, this_val, 1, (JSValueConst[]){value});
@@ -1332,4 +1482,18 @@ TIC_EXPORT const tic_script EXPORT_SCRIPT(Js) =
 
     .demo = {DemoRom, sizeof DemoRom},
     .mark = {MarkRom, sizeof MarkRom, "jsmark.tic"},
+
+    .bytecode =
+    {
+        .version        = QUICKJS_VERSION,
+        .compile        = compileJavascript,
+        .load           = loadJavascript,
+    },
+
+    .gc =
+    {
+        .step           = gcStepJavascript,
+    },
+
+    .seed               = seedJavascript,
 };
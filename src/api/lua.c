@@ -29,16 +29,21 @@
 #include <lualib.h>
 #include <ctype.h>
 
-static bool initLua(tic_mem* tic, const char* code)
+static void initLuaState(tic_core* core)
 {
-    tic_core* core = (tic_core*)tic;
+    luaapi_close((tic_mem*)core);
 
-    luaapi_close(tic);
-
-    lua_State* lua = core->currentVM = luaL_newstate();
+    lua_State* lua = core->currentVM = luaapi_newstate(core);
     luaapi_open(lua);
 
     luaapi_init(core);
+}
+
+static bool initLua(tic_mem* tic, const char* code)
+{
+    tic_core* core = (tic_core*)tic;
+
+    initLuaState(core);
 
     {
         lua_State* lua = core->currentVM;
@@ -55,6 +60,20 @@ static bool initLua(tic_mem* tic, const char* code)
     return true;
 }
 
+static void* compileLua(tic_mem* tic, const char* code, s32* size)
+{
+    return luaapi_compile((tic_core*)tic, code, size);
+}
+
+static bool loadLua(tic_mem* tic, const void* buffer, s32 size)
+{
+    tic_core* core = (tic_core*)tic;
+
+    initLuaState(core);
+
+    return luaapi_load(core, buffer, size);
+}
+
 static const char* const LuaKeywords [] =
 {
     "and", "break", "do", "else", "elseif",
@@ -260,4 +279,19 @@ TIC_EXPORT const tic_script EXPORT_SCRIPT(Lua) =
         {DemoCar,       sizeof DemoCar,         "car.tic"},
         {0},
     },
+
+    .bytecode =
+    {
+        .version        = LUA_RELEASE,
+        .compile        = compileLua,
+        .load           = loadLua,
+    },
+
+    .gc =
+    {
+        .step           = luaapi_gc_step,
+        .heap           = luaapi_gc_heap,
+    },
+
+    .seed               = luaapi_seed,
 };
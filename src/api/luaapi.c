@@ -1630,24 +1630,125 @@ void luaapi_open(lua_State *lua)
     }
 }
 
-void luaapi_init(tic_core* core)
+static const struct{lua_CFunction func; const char* name;} ApiItems[] =
 {
-    static const struct{lua_CFunction func; const char* name;} ApiItems[] =
-    {
 #define API_FUNC_DEF(name, ...) {(lua_CFunction)(lua_ ## name), #name},
-        TIC_API_LIST(API_FUNC_DEF)
+    TIC_API_LIST(API_FUNC_DEF)
 #undef  API_FUNC_DEF
 
 #if defined(BUILD_DEPRECATED)
-        {(lua_CFunction)lua_textri, "textri"},
+    {(lua_CFunction)lua_textri, "textri"},
 #endif
-    };
 
+    {lua_dofile, "dofile"},
+    {lua_loadfile, "loadfile"},
+};
+
+// math.random is xoshiro256** seeded from the clock in luaopen_math
+static void seedLua(lua_State* lua, u32 seed)
+{
+    s32 top = lua_gettop(lua);
+
+    if(lua_getglobal(lua, LUA_MATHLIBNAME) == LUA_TTABLE
+        && lua_getfield(lua, -1, "randomseed") == LUA_TFUNCTION)
+    {
+        lua_pushinteger(lua, seed);
+        lua_pcall(lua, 1, 0, 0);
+    }
+
+    lua_settop(lua, top);
+}
+
+// the core steps the collector in the idle time between frames (see tic_core_gc),
+// so the automatic one waits until the heap is four times the live data
+// and only steps in mid-frame on carts that leave no idle time at all
+static void tuneLuaGC(lua_State* lua)
+{
+    enum {Pause = 400};
+
+#if defined(LUA_GCINC)
+    lua_gc(lua, LUA_GCINC, Pause, 0, 0);
+#else
+    lua_gc(lua, LUA_GCSETPAUSE, Pause);
+#endif
+}
+
+void luaapi_init(tic_core* core)
+{
     for (s32 i = 0; i < COUNT_OF(ApiItems); i++)
         registerLuaFunction(core, ApiItems[i].func, ApiItems[i].name);
 
-    registerLuaFunction(core, lua_dofile, "dofile");
-    registerLuaFunction(core, lua_loadfile, "loadfile");
+    tuneLuaGC(core->currentVM);
+
+    // the libs are open and the cart code hasn't run yet
+    if(core->seed.set)
+        seedLua(core->currentVM, core->seed.value);
+}
+
+void luaapi_seed(tic_mem* tic, u32 seed)
+{
+    seedLua(((tic_core*)tic)->currentVM, seed);
+}
+
+void luaapi_names(lua_State* lua)
+{
+    lua_createtable(lua, COUNT_OF(ApiItems), 0);
+
+    for (s32 i = 0; i < COUNT_OF(ApiItems); i++)
+    {
+        lua_pushstring(lua, ApiItems[i].name);
+        lua_rawseti(lua, -2, i + 1);
+    }
+}
+
+bool luaapi_gc_step(tic_mem* tic)
+{
+    tic_core* core = (tic_core*)tic;
+
+    // 1K of work per step keeps a single step well under a millisecond,
+    // the VM is kept in the incremental mode, so the result means 'cycle finished'
+    return lua_gc(core->currentVM, LUA_GCSTEP, 1) != 0;
+}
+
+s32 luaapi_gc_heap(tic_mem* tic)
+{
+    tic_core* core = (tic_core*)tic;
+    lua_State* lua = core->currentVM;
+
+    return lua_gc(lua, LUA_GCCOUNT, 0) * 1024 + lua_gc(lua, LUA_GCCOUNTB, 0);
+}
+
+// Lua passes the block sizes, so the arena keeps no header for them
+static void* luaapi_alloc(void* ud, void* ptr, size_t osize, size_t nsize)
+{
+    tic_core* core = ud;
+    return core->arena.realloc(ud, ptr, osize, nsize);
+}
+
+static s32 luaapi_panic(lua_State* lua)
+{
+    void* ud = NULL;
+    lua_getallocf(lua, &ud);
+    tic_core* core = ud;
+
+    const char* msg = lua_tostring(lua, -1);
+    core->data->error(core->data->data, msg ? msg : "unprotected error in Lua");
+
+    // returning from here aborts the host
+    if(core->panic)
+        longjmp(*core->panic, 1);
+
+    return 0;
+}
+
+lua_State* luaapi_newstate(tic_core* core)
+{
+    lua_State* lua = lua_newstate(luaapi_alloc, core);
+
+    if(lua)
+        lua_atpanic(lua, luaapi_panic);
+
+    return lua;
 }
 
 void luaapi_close(tic_mem* tic)
@@ -1656,11 +1757,88 @@ void luaapi_close(tic_mem* tic)
 
     if(core->currentVM)
     {
-        lua_close(core->currentVM);
+        // all the state is in the arena, the carts have nothing for __gc to close
+        core->arena.release(tic);
         core->currentVM = NULL;
     }
 }
 
+typedef struct
+{
+    u8* data;
+    s32 size;
+} DumpBuffer;
+
+static s32 dumpWriter(lua_State* lua, const void* data, size_t size, void* ud)
+{
+    DumpBuffer* buffer = ud;
+
+    u8* ptr = realloc(buffer->data, buffer->size + size);
+
+    if(!ptr)
+        return 1;
+
+    memcpy(ptr + buffer->size, data, size);
+    buffer->data = ptr;
+    buffer->size += (s32)size;
+
+    return 0;
+}
+
+void* luaapi_dump(lua_State* lua, s32* size)
+{
+    DumpBuffer buffer = {NULL, 0};
+
+    if(lua_dump(lua, dumpWriter, &buffer, 0) != 0)
+    {
+        FREE(buffer.data);
+        return NULL;
+    }
+
+    *size = buffer.size;
+    return buffer.data;
+}
+
+void* luaapi_compile(tic_core* core, const char* code, s32* size)
+{
+    // luaL_loadstring uses the code as the chunk name, but only the
+    // first line of it gets into error messages, so keep just that
+    char name[LUA_IDSIZE + 1];
+    {
+        const char* nl = strchr(code, '\n');
+        s32 len = MIN(nl ? (s32)(nl - code) + 1 : (s32)strlen(code), LUA_IDSIZE);
+        memcpy(name, code, len);
+        name[len] = '\0';
+    }
+
+    lua_State* lua = luaapi_newstate(core);
+
+    if(!lua)
+        return NULL;
+
+    void* buffer = luaL_loadbuffer(lua, code, strlen(code), name) == LUA_OK
+        ? luaapi_dump(lua, size)
+        : NULL;
+    lua_close(lua);
+
+    return buffer;
+}
+
+bool luaapi_load(tic_core* core, const void* buffer, s32 size)
+{
+    lua_State* lua = core->currentVM;
+
+    lua_settop(lua, 0);
+
+    if(luaL_loadbufferx(lua, buffer, size, "=game", "b") != LUA_OK || lua_pcall(lua, 0, LUA_MULTRET, 0) != LUA_OK)
+    {
+        core->data->error(core->data->data, lua_tostring(lua, -1));
+        return false;
+    }
+
+    return true;
+}
+
 /*
 ** Message handler which appends stract trace to exceptions.
 ** This function was extractred from lua.c.
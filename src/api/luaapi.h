@@ -30,10 +30,18 @@
 #include <ctype.h>
 
 void luaapi_init(tic_core* core);
+void luaapi_names(lua_State* lua);
 void luaapi_tick(tic_mem* tic);
 void luaapi_boot(tic_mem* tic);
 void luaapi_scn(tic_mem* tic, s32 row, void* data);
 void luaapi_bdr(tic_mem* tic, s32 row, void* data);
 void luaapi_menu(tic_mem* tic, s32 index, void* data);
+lua_State* luaapi_newstate(tic_core* core);
 void luaapi_close(tic_mem* tic);
+void luaapi_seed(tic_mem* tic, u32 seed);
+bool luaapi_gc_step(tic_mem* tic);
+s32 luaapi_gc_heap(tic_mem* tic);
 void luaapi_open(lua_State *lua);
+void* luaapi_dump(lua_State* lua, s32* size);
+void* luaapi_compile(tic_core* core, const char* code, s32* size);
+bool luaapi_load(tic_core* core, const void* buffer, s32 size);
@@ -74,40 +74,69 @@ static void evalMoonscript(tic_mem* tic, const char* code) {
 
 extern s32 luaopen_lpeg(lua_State *lua);
 
-static bool initMoonscript(tic_mem* tic, const char* code)
+static const char* compile_moonscript_src = MOON_CODE(
+    return require('moonscript.base').to_lua(...)
+);
+
+static void openMoonscriptLibs(lua_State* moon)
 {
-    tic_core* core = (tic_core*)tic;
-    luaapi_close(tic);
+    luaapi_open(moon);
+
+    luaopen_lpeg(moon);
+    setloaded(moon, "lpeg");
+}
+
+static const char* openMoonscript(lua_State* moon)
+{
+    lua_settop(moon, 0);
+
+    if (luaL_loadbuffer(moon, (const char *)moonscript_lua, moonscript_lua_len, "moonscript.lua") != LUA_OK)
+        return "failed to load moonscript.lua";
 
-    lua_State* lua = core->currentVM = luaL_newstate();
-    luaapi_open(lua);
+    lua_call(moon, 0, 0);
 
-    luaopen_lpeg(lua);
-    setloaded(lua, "lpeg");
+    return NULL;
+}
 
+static bool initMoonscriptState(tic_core* core)
+{
+    luaapi_close((tic_mem*)core);
+
+    lua_State* lua = core->currentVM = luaapi_newstate(core);
+
+    openMoonscriptLibs(lua);
     luaapi_init(core);
 
+    const char* err = openMoonscript(lua);
+
+    if (err)
     {
-        lua_State* moon = lua;
+        core->data->error(core->data->data, err);
+        return false;
+    }
 
-        lua_settop(moon, 0);
+    if (luaL_loadbuffer(lua, execute_moonscript_src, strlen(execute_moonscript_src), "execute_moonscript") != LUA_OK)
+    {
+        core->data->error(core->data->data, "failed to load moonscript compiler");
+        return false;
+    }
 
-        if (luaL_loadbuffer(moon, (const char *)moonscript_lua, moonscript_lua_len, "moonscript.lua") != LUA_OK)
-        {
-            core->data->error(core->data->data, "failed to load moonscript.lua");
-            return false;
-        }
+    lua_setglobal(lua, _ms_loadstring);
+
+    return true;
+}
 
-        lua_call(moon, 0, 0);
+static bool initMoonscript(tic_mem* tic, const char* code)
+{
+    tic_core* core = (tic_core*)tic;
 
-        if (luaL_loadbuffer(moon, execute_moonscript_src, strlen(execute_moonscript_src), "execute_moonscript") != LUA_OK)
-        {
-            core->data->error(core->data->data, "failed to load moonscript compiler");
-            return false;
-        }
+    if (!initMoonscriptState(core))
+        return false;
+
+    {
+        lua_State* moon = core->currentVM;
 
-        lua_setglobal(lua, _ms_loadstring);
-        lua_getglobal(lua, _ms_loadstring);
+        lua_getglobal(moon, _ms_loadstring);
 
         lua_pushstring(moon, code);
         if (lua_pcall(moon, 1, 1, 0) != LUA_OK)
@@ -125,6 +154,43 @@ static bool initMoonscript(tic_mem* tic, const char* code)
     return true;
 }
 
+static void* compileMoonscript(tic_mem* tic, const char* code, s32* size)
+{
+    void* buffer = NULL;
+    lua_State* moon = luaapi_newstate((tic_core*)tic);
+
+    if (!moon)
+        return NULL;
+
+    openMoonscriptLibs(moon);
+
+    if (!openMoonscript(moon)
+        && luaL_loadbuffer(moon, compile_moonscript_src, strlen(compile_moonscript_src), "compile_moonscript") == LUA_OK)
+    {
+        lua_pushstring(moon, code);
+
+        if (lua_pcall(moon, 1, 1, 0) == LUA_OK && lua_isstring(moon, -1))
+        {
+            size_t len = 0;
+            const char* lua = lua_tolstring(moon, -1, &len);
+
+            if (luaL_loadbuffer(moon, lua, len, "=(moonscript.loadstring)") == LUA_OK)
+                buffer = luaapi_dump(moon, size);
+        }
+    }
+
+    lua_close(moon);
+
+    return buffer;
+}
+
+static bool loadMoonscript(tic_mem* tic, const void* buffer, s32 size)
+{
+    tic_core* core = (tic_core*)tic;
+
+    return initMoonscriptState(core) && luaapi_load(core, buffer, size);
+}
+
 static const char* const MoonKeywords [] =
 {
     "false", "true", "nil", "local", "return",
@@ -233,4 +299,19 @@ TIC_EXPORT const tic_script EXPORT_SCRIPT(Moon) =
 
     .demo = {DemoRom, sizeof DemoRom},
     .mark = {MarkRom, sizeof MarkRom, "moonmark.tic"},
+
+    .bytecode =
+    {
+        .version        = LUA_RELEASE,
+        .compile        = compileMoonscript,
+        .load           = loadMoonscript,
+    },
+
+    .gc =
+    {
+        .step           = luaapi_gc_step,
+        .heap           = luaapi_gc_heap,
+    },
+
+    .seed               = luaapi_seed,
 };
@@ -28,6 +28,7 @@
 #include "tools.h"
 
 #include <ctype.h>
+#include <assert.h>
 
 // Avoid redefining u* and s*
 #define d_m3ShortTypesDefined 1
@@ -1079,27 +1080,55 @@ static void closeWasm(tic_mem* tic)
 
     if(core->currentVM)
     {
-        // this is necessary because when TIC-80 calls tic_reset_api, we
-        // may not even have a VM.  Because the [non WASM] VM isn't
-        // initialized yet when loading a new cartridge the "init" steps
-        // are being applied to the WASM RAM, not the base RAM, so as we're
-        // on our way out we need to copy the our lower 96kb back into base
-        // RAM to close this loophole
-
-        // TODO: This could also be fixed by correcting the sequencing such
-        // that prior VMs were released before starting the init process
-        // for an entirely different VM.  This sequencing matters a lot
-        // less if one assumes (like before) that all the VMs share a
-        // common memory area.
-        u8* low_ram =  (u8*)core->memory.base_ram;
-        u8* wasm_ram = m3_GetMemory(core->currentVM, NULL, 0);
-        memcpy(low_ram, wasm_ram, TIC_RAM_SIZE);
-        deinitWasmRuntime(core->currentVM);
+        IM3Runtime runtime = core->currentVM;
+
+        // the linear memory is the TIC RAM block owned by the core,
+        // detach it so wasm3 doesn't free it and give the heap back
+        runtime->memory.mallocated = NULL;
+
+        deinitWasmRuntime(runtime);
         core->currentVM = NULL;
-        core->memory.ram = NULL;
+
+        core->ramresize(tic, TIC_RAM_SIZE);
     }
 }
 
+static_assert(sizeof(M3MemoryHeader) <= TIC_RAM_HEADER_SIZE, "wasm memory header");
+static_assert(TIC_WASM_PAGE_COUNT * TIC_WASM_PAGE_SIZE >= TIC_RAM_SIZE, "wasm page count");
+
+static M3Result initWasmMemory(tic_core* core, IM3Runtime runtime, IM3Module module)
+{
+    // TIC RAM is at the start of the linear memory, so the cart has to
+    // import it instead of declaring its own
+    if(!module->memoryImported)
+        return "Error: WASM must import memory from env";
+
+    // the cart can ask for a bigger heap with the initial memory size
+    u32 pages = MAX(module->memoryInfo.initPages, TIC_WASM_PAGE_COUNT);
+
+    if(pages > TIC_WASM_MAX_PAGE_COUNT)
+        return "Error: WASM memory is too large";
+
+    if(module->memoryInfo.maxPages && pages > module->memoryInfo.maxPages)
+        return "Error: WASM memory max size is too small";
+
+    if(!core->ramresize(&core->memory, pages * TIC_WASM_PAGE_SIZE))
+        return "Error: unable to allocate WASM memory";
+
+    // wasm3 keeps its header right before the linear memory
+    M3MemoryHeader* header = (M3MemoryHeader*)((u8*)core->memory.ram - sizeof(M3MemoryHeader));
+    header->runtime = runtime;
+    header->maxStack = (m3slot_t*)runtime->stack + runtime->numStackSlots;
+    header->length = pages * TIC_WASM_PAGE_SIZE;
+
+    runtime->memory.mallocated = header;
+    runtime->memory.numPages = pages;
+    // memory.grow would realloc the block behind the core's back
+    runtime->memory.maxPages = pages;
+
+    return m3Err_none;
+}
+
 // TODO: restore functionality
 // static u64 ForceExitCounter = 0;
 
@@ -1131,14 +1160,6 @@ static bool initWasm(tic_mem* tic, const char* code)
         return false;
     }
 
-    runtime->memory.maxPages = TIC_WASM_PAGE_COUNT;
-    ResizeMemory(runtime, TIC_WASM_PAGE_COUNT);
-
-    u8* low_ram =  (u8*)core->memory.ram;
-    u8* wasm_ram = m3_GetMemory(runtime, NULL, 0);
-    memcpy(wasm_ram, low_ram, TIC_RAM_SIZE);
-    core->memory.ram = (tic_ram*)wasm_ram;
-
     core->currentVM = runtime;
 
     // TODO: if compiling from WAT is an option where should this
@@ -1154,23 +1175,33 @@ static bool initWasm(tic_mem* tic, const char* code)
     //  return false;
     // }
 
-    void* wasmcode = tic->cart.binary.data;
+    void* wasmcode = tic->cart->binary.data;
     // TODO: will this blow up or have bad effects if we are zero-padded?
     // if so we'll need to find a way to pass in size here
     // int fsize = TIC_BINARY_SIZE;
-    int fsize = tic->cart.binary.size;
+    int fsize = tic->cart->binary.size;
 
     IM3Module module;
     M3Result result = m3_ParseModule (runtime->environment, &module, wasmcode, fsize);
 
     if (result){
         core->data->error(core->data->data, result);
+        closeWasm(tic);
+        return false;
+    }
+
+    result = initWasmMemory(core, runtime, module);
+    if (result){
+        m3_FreeModule(module);
+        core->data->error(core->data->data, result);
+        closeWasm(tic);
         return false;
     }
 
     result = m3_LoadModule (runtime, module);
     if (result){
         core->data->error(core->data->data, result);
+        closeWasm(tic);
         return false;
     }
 
@@ -1178,9 +1209,29 @@ static bool initWasm(tic_mem* tic, const char* code)
     if (result)
     {
         core->data->error(core->data->data, result);
+        closeWasm(tic);
         return false;
     }
 
+#if defined(TIC_WASM_EAGER_COMPILE)
+    {
+        // wasm3 compiles functions on the first call, which makes the
+        // first frames stutter, so compile everything up front instead
+        u64 start = core->data->counter(core->data->data);
+
+        result = m3_CompileModule(module);
+        if (result)
+        {
+            core->data->error(core->data->data, result);
+            closeWasm(tic);
+            return false;
+        }
+
+        dbg("WASM module compiled in %.2f ms\n",
+            (double)(core->data->counter(core->data->data) - start) * 1000.0 / core->data->freq(core->data->data));
+    }
+#endif
+
     m3_FindFunction (&BDR_function, runtime, BDR_FN);
     m3_FindFunction (&SCN_function, runtime, SCN_FN);
     m3_FindFunction (&BOOT_function, runtime, BOOT_FN);
@@ -1322,6 +1373,166 @@ static const tic_outline_item* getWasmOutline(const char* code, s32* size)
     return items;
 }
 
+// the linear memory is the TIC RAM block the core saves already,
+// so the snapshot is just the globals, the stack is empty between frames
+static s32 wasmSnapshotSize(tic_mem* tic)
+{
+    IM3Runtime runtime = ((tic_core*)tic)->currentVM;
+    return runtime->modules->numGlobals * sizeof(u64);
+}
+
+typedef struct
+{
+    const u8* ptr;
+    const u8* end;
+} WasmReader;
+
+static bool wasmReadLeb(WasmReader* reader, u32* value)
+{
+    u32 result = 0;
+
+    for(s32 shift = 0; reader->ptr < reader->end && shift < 35; shift += 7)
+    {
+        u8 byte = *reader->ptr++;
+        result |= (u32)(byte & 0x7f) << shift;
+
+        if(!(byte & 0x80))
+        {
+            *value = result;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool wasmSkip(WasmReader* reader, u32 size)
+{
+    if(size > reader->end - reader->ptr)
+        return false;
+
+    reader->ptr += size;
+    return true;
+}
+
+static bool wasmReadLimits(WasmReader* reader, u32* min)
+{
+    if(reader->ptr >= reader->end)
+        return false;
+
+    u8 flags = *reader->ptr++;
+    u32 max;
+
+    return wasmReadLeb(reader, min) && (!(flags & 1) || wasmReadLeb(reader, &max));
+}
+
+static void wasmReadImports(WasmReader* reader, u32* pages, u32* globals)
+{
+    u32 count, size, value;
+
+    if(!wasmReadLeb(reader, &count))
+        return;
+
+    for(u32 i = 0; i < count; i++)
+    {
+        // module and field names
+        if(!wasmReadLeb(reader, &size) || !wasmSkip(reader, size)
+            || !wasmReadLeb(reader, &size) || !wasmSkip(reader, size)
+            || reader->ptr >= reader->end)
+            return;
+
+        switch(*reader->ptr++)
+        {
+        case 0: // function
+            if(!wasmReadLeb(reader, &value)) return;
+            break;
+        case 1: // table
+            if(!wasmSkip(reader, 1) || !wasmReadLimits(reader, &value)) return;
+            break;
+        case 2: // memory
+            if(!wasmReadLimits(reader, &value)) return;
+            *pages = MAX(*pages, value);
+            break;
+        case 3: // global
+            if(!wasmSkip(reader, 2)) return;
+            (*globals)++;
+            break;
+        default:
+            return;
+        }
+    }
+}
+
+// what the state of this cart can take: the pages its memory asks for
+// and the globals, both read from the binary so the size is known
+// before the VM is made and stays the same for the whole session
+static s32 wasmSnapshotBound(tic_mem* tic)
+{
+    const tic_binary* binary = &tic->cart->binary;
+    u32 pages = TIC_WASM_PAGE_COUNT, globals = 0;
+
+    // magic and version
+    enum {Preamble = 8};
+
+    if(binary->size > Preamble && binary->size <= TIC_BINARY_SIZE)
+    {
+        WasmReader reader = {(const u8*)binary->data + Preamble, (const u8*)binary->data + binary->size};
+
+        while(reader.ptr < reader.end)
+        {
+            u8 id = *reader.ptr++;
+            u32 size, value;
+
+            if(!wasmReadLeb(&reader, &size) || size > reader.end - reader.ptr)
+                break;
+
+            WasmReader section = {reader.ptr, reader.ptr + size};
+            reader.ptr += size;
+
+            switch(id)
+            {
+            case 2: // imports
+                wasmReadImports(&section, &pages, &globals);
+                break;
+            case 5: // memory
+                if(wasmReadLeb(&section, &value) && value && wasmReadLimits(&section, &value))
+                    pages = MAX(pages, value);
+                break;
+            case 6: // globals
+                if(wasmReadLeb(&section, &value))
+                    globals += value;
+                break;
+            }
+        }
+    }
+
+    // a bigger cart doesn't start, a broken binary has nothing to save
+    pages = MIN(pages, TIC_WASM_MAX_PAGE_COUNT);
+    globals = MIN(globals, TIC_BINARY_SIZE);
+
+    return pages * TIC_WASM_PAGE_SIZE + globals * sizeof(u64);
+}
+
+static void saveWasmSnapshot(tic_mem* tic, void* buffer)
+{
+    IM3Runtime runtime = ((tic_core*)tic)->currentVM;
+    IM3Module module = runtime->modules;
+
+    for(u32 i = 0; i < module->numGlobals; i++)
+        memcpy((u64*)buffer + i, &module->globals[i].i64Value, sizeof(u64));
+}
+
+static bool loadWasmSnapshot(tic_mem* tic, const void* buffer)
+{
+    IM3Runtime runtime = ((tic_core*)tic)->currentVM;
+    IM3Module module = runtime->modules;
+
+    for(u32 i = 0; i < module->numGlobals; i++)
+        memcpy(&module->globals[i].i64Value, (const u64*)buffer + i, sizeof(u64));
+
+    return true;
+}
+
 void evalWasm(tic_mem* tic, const char* code) {
     printf("TODO: Wasm eval not yet implemented\n.");
 }
@@ -1370,7 +1581,16 @@ TIC_EXPORT const tic_script EXPORT_SCRIPT(Wasm) =
     .keywords           = NULL,
     .keywordsCount      = 0,
     .useBinarySection   = true,
+    .directRam          = true,
 
     .demo = {DemoRom, sizeof DemoRom},
     .mark = {MarkRom, sizeof MarkRom, "wasmmark.tic"},
+
+    .snapshot =
+    {
+        .size           = wasmSnapshotSize,
+        .save           = saveWasmSnapshot,
+        .load           = loadWasmSnapshot,
+        .bound          = wasmSnapshotBound,
+    },
 };
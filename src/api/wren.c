@@ -1687,6 +1687,11 @@ static void writeFn(WrenVM* vm, const char* text)
     core->data->trace(core->data->data, text ? text : "null", color);
 }
 
+static void* reallocateFn(void* memory, size_t newSize, void* userData)
+{
+    return tic_vm_realloc(userData, memory, newSize);
+}
+
 static bool initWren(tic_mem* tic, const char* code)
 {
     tic_core* core = (tic_core*)tic;
@@ -1696,6 +1701,8 @@ static bool initWren(tic_mem* tic, const char* code)
     wrenInitConfiguration(&config);
 
     config.bindForeignMethodFn = bindForeignMethod;
+    config.reallocateFn = reallocateFn;
+    config.userData = core;
 
     config.errorFn = reportError;
     config.writeFn = writeFn;
@@ -63,22 +63,45 @@ static void evalYuescript(tic_mem* tic, const char* code)
     }
 }
 
-static bool initYuescript(tic_mem* tic, const char* code)
+static void initYuescriptState(tic_core* core)
 {
-    tic_core* core = (tic_core*)tic;
-    luaapi_close(tic);
+    luaapi_close((tic_mem*)core);
 
-    core->currentVM = luaL_newstate();
+    core->currentVM = luaapi_newstate(core);
     lua_State* lua = (lua_State*)core->currentVM;
     luaapi_open(lua);
 
     luaapi_init(core);
+}
+
+static bool initYuescript(tic_mem* tic, const char* code)
+{
+    tic_core* core = (tic_core*)tic;
+
+    initYuescriptState(core);
 
     evalYuescript(tic, code);
 
     return true;
 }
 
+static void* compileYuescript(tic_mem* tic, const char* code, s32* size)
+{
+    yue::YueCompiler compiler;
+    auto result = compiler.compile(code, yue::YueConfig());
+
+    return result.error ? nullptr : luaapi_compile((tic_core*)tic, result.codes.c_str(), size);
+}
+
+static bool loadYuescript(tic_mem* tic, const void* buffer, s32 size)
+{
+    tic_core* core = (tic_core*)tic;
+
+    initYuescriptState(core);
+
+    return luaapi_load(core, buffer, size);
+}
+
 static const char* const YueKeywords[] =
     {
         "false",
@@ -228,5 +251,14 @@ extern "C" TIC_EXPORT const tic_script EXPORT_SCRIPT(Yue) = {
      MarkRom,
      sizeof MarkRom,
      "yuemark.tic"},
-    nullptr // demos
+    nullptr, // demos
+    {        // bytecode
+     LUA_RELEASE,
+     compileYuescript,
+     loadYuescript},
+    {        // gc
+     luaapi_gc_step,
+     luaapi_gc_heap},
+    {},          // snapshot
+    luaapi_seed, // seed
 };
\ No newline at end of file
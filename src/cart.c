@@ -30,6 +30,7 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include "tic_assert.h"
 #include "tools.h"
 #include "ext/png.h"
@@ -77,6 +78,10 @@ static_assert(sizeof(Chunk) == 4, "tic_chunk_size");
 static const u8 Sweetie16[] = {0x1a, 0x1c, 0x2c, 0x5d, 0x27, 0x5d, 0xb1, 0x3e, 0x53, 0xef, 0x7d, 0x57, 0xff, 0xcd, 0x75, 0xa7, 0xf0, 0x70, 0x38, 0xb7, 0x64, 0x25, 0x71, 0x79, 0x29, 0x36, 0x6f, 0x3b, 0x5d, 0xc9, 0x41, 0xa6, 0xf6, 0x73, 0xef, 0xf7, 0xf4, 0xf4, 0xf4, 0x94, 0xb0, 0xc2, 0x56, 0x6c, 0x86, 0x33, 0x3c, 0x57};
 static const u8 Waveforms[] = {0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe, 0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe};
 
+#if defined(BUILD_DEPRECATED)
+static const u8 DB16[] = { 0x14, 0x0c, 0x1c, 0x44, 0x24, 0x34, 0x30, 0x34, 0x6d, 0x4e, 0x4a, 0x4e, 0x85, 0x4c, 0x30, 0x34, 0x65, 0x24, 0xd0, 0x46, 0x48, 0x75, 0x71, 0x61, 0x59, 0x7d, 0xce, 0xd2, 0x7d, 0x2c, 0x85, 0x95, 0xa1, 0x6d, 0xaa, 0x2c, 0xd2, 0xaa, 0x99, 0x6d, 0xc2, 0xca, 0xda, 0xd4, 0x5e, 0xde, 0xee, 0xd6 };
+#endif
+
 static s32 chunkSize(const Chunk* chunk)
 {
     return chunk->size == 0 && (chunk->type == CHUNK_CODE || chunk->type == CHUNK_BINARY) ? TIC_BANK_SIZE : retro_le_to_cpu16(chunk->size);
@@ -84,14 +89,19 @@ static s32 chunkSize(const Chunk* chunk)
 
 static png_buffer getRawCartFromPng(png_buffer buffer)
 {
-    png_buffer zip = png_decode(buffer);
+    // inflate right from the cart chunk if there is one,
+    // only steganography needs the pixels decoded
+    png_buffer chunk = png_cart(buffer);
+    png_buffer zip = chunk.size ? chunk : png_decode(buffer);
 
     if (zip.size)
     {
         png_buffer buf = png_create(sizeof(tic_cartridge));
 
         buf.size = tic_tool_unzip(buf.data, buf.size, zip.data, zip.size);
-        free(zip.data);
+
+        if(!chunk.size)
+            free(zip.data);
 
         if(buf.size)
             return buf;
@@ -118,14 +128,63 @@ tic_cartridge* loadPngCart(png_buffer buffer)
     return NULL;
 }
 
-void tic_cart_load(tic_cartridge* cart, const u8* buffer, s32 size)
+typedef struct
+{
+    const u8* data; // NULL if the cart has no such chunk
+    s32 size;
+} ChunkRef;
+
+typedef struct
+{
+    ChunkRef chunks[1 << 5][TIC_BANKS]; // by type and bank
+} ChunkIndex;
+
+// remember where every complete chunk of the stream is,
+// returns the size of the indexed part
+static s32 indexChunks(ChunkIndex* index, const u8* buffer, s32 size)
 {
-    memset(cart, 0, sizeof(tic_cartridge));
+    const u8* ptr = buffer;
     const u8* end = buffer + size;
+
+    while(end - ptr >= (s32)sizeof(Chunk))
+    {
+        Chunk chunk;
+        memcpy(&chunk, ptr, sizeof(Chunk));
+
+        s32 size = chunkSize(&chunk);
+
+        if(end - ptr - (s32)sizeof(Chunk) < size)
+            break;
+
+        ptr += sizeof(Chunk);
+
+        // the latest chunk wins, as before
+        index->chunks[chunk.type][chunk.bank] = (ChunkRef){ptr, size};
+        ptr += size;
+    }
+
+    return (s32)(ptr - buffer);
+}
+
+static void loadSection(void* dst, s32 size, const ChunkRef* chunk)
+{
+    s32 count = chunk->data ? MIN(size, chunk->size) : 0;
+
+    if(count)
+        memcpy(dst, chunk->data, count);
+
+    memset((u8*)dst + count, 0, size - count);
+}
+
+static_assert(sizeof(tic_bank) == sizeof(tic_screen) + sizeof(tic_tiles) + sizeof(tic_sprites) + sizeof(tic_map)
+    + sizeof(tic_sfx) + sizeof(tic_music) + sizeof(tic_flags) + sizeof(tic_palettes), "tic_bank has padding");
+
+void tic_cart_load(tic_cartridge* cart, const u8* buffer, s32 size)
+{
     u8 *chunk_cart = NULL;
 
     // check if this cartridge is in PNG format
-    if (!memcmp(buffer, "\x89PNG", 4))
+    if (size >= 4 && !memcmp(buffer, "\x89PNG", 4))
     {
         png_buffer buf = getRawCartFromPng((png_buffer){.data = (u8*)buffer, .size = size});
 
@@ -134,195 +193,358 @@ void tic_cart_load(tic_cartridge* cart, const u8* buffer, s32 size)
             chunk_cart = buf.data;
             buffer = buf.data;
             size = buf.size;
-            end = buffer + size;
         }
         else
+        {
+            memset(cart, 0, sizeof(tic_cartridge));
             return;
+        }
     }
 
-#define LOAD_CHUNK(to) memcpy(&to, ptr, MIN(sizeof(to), chunk->size ? retro_le_to_cpu16(chunk->size) : TIC_BANK_SIZE))
+    ChunkIndex index = {0};
+    indexChunks(&index, buffer, size);
 
-    // load palette chunk first
-    {
-        const u8* ptr = buffer;
-        while (ptr < end)
-        {
-            const Chunk* chunk = (Chunk*)ptr;
-            ptr += sizeof(Chunk);
-
-            switch (chunk->type)
-            {
-            case CHUNK_PALETTE:
-                LOAD_CHUNK(cart->banks[chunk->bank].palette);
-                break;
-            case CHUNK_DEFAULT:
-                memcpy(&cart->banks[chunk->bank].palette, Sweetie16, sizeof Sweetie16);
-                memcpy(&cart->banks[chunk->bank].sfx.waveforms, Waveforms, sizeof Waveforms);
-                break;
-            default: break;
-            }
+#define CHUNK(type, bank) (&index.chunks[type][bank])
+#define LOAD_CHUNK(to, type, bank) loadSection(&(to), sizeof(to), CHUNK(type, bank))
 
-            ptr += chunkSize(chunk);
-        }
+    for(s32 i = 0; i < TIC_BANKS; i++)
+    {
+        tic_bank* bank = &cart->banks[i];
+        bool def = CHUNK(CHUNK_DEFAULT, i)->data != NULL;
+
+        LOAD_CHUNK(bank->palette, CHUNK_PALETTE, i);
+        if(def && !CHUNK(CHUNK_PALETTE, i)->data)
+            memcpy(&bank->palette, Sweetie16, sizeof Sweetie16);
+
+        LOAD_CHUNK(bank->sfx.waveforms, CHUNK_WAVEFORM, i);
+        if(def && !CHUNK(CHUNK_WAVEFORM, i)->data)
+            memcpy(&bank->sfx.waveforms, Waveforms, sizeof Waveforms);
+
+        LOAD_CHUNK(bank->tiles,             CHUNK_TILES,    i);
+        LOAD_CHUNK(bank->sprites,           CHUNK_SPRITES,  i);
+        LOAD_CHUNK(bank->map,               CHUNK_MAP,      i);
+        LOAD_CHUNK(bank->sfx.samples,       CHUNK_SAMPLES,  i);
+        LOAD_CHUNK(bank->music.tracks,      CHUNK_MUSIC,    i);
+        LOAD_CHUNK(bank->music.patterns,    CHUNK_PATTERNS, i);
+        LOAD_CHUNK(bank->flags,             CHUNK_FLAGS,    i);
+        LOAD_CHUNK(bank->screen,            CHUNK_SCREEN,   i);
 
 #if defined(BUILD_DEPRECATED)
-        // workaround to support ancient carts without palette
-        // load DB16 palette if it not exists
-        if (EMPTY(cart->bank0.palette.vbank0.data))
+        if(!CHUNK(CHUNK_PATTERNS, i)->data && CHUNK(CHUNK_PATTERNS_DEP, i)->data)
         {
-            static const u8 DB16[] = { 0x14, 0x0c, 0x1c, 0x44, 0x24, 0x34, 0x30, 0x34, 0x6d, 0x4e, 0x4a, 0x4e, 0x85, 0x4c, 0x30, 0x34, 0x65, 0x24, 0xd0, 0x46, 0x48, 0x75, 0x71, 0x61, 0x59, 0x7d, 0xce, 0xd2, 0x7d, 0x2c, 0x85, 0x95, 0xa1, 0x6d, 0xaa, 0x2c, 0xd2, 0xaa, 0x99, 0x6d, 0xc2, 0xca, 0xda, 0xd4, 0x5e, 0xde, 0xee, 0xd6 };
-            memcpy(cart->bank0.palette.vbank0.data, DB16, sizeof DB16);
+            // workaround to load deprecated music patterns section
+            // and automatically convert volume value to a command
+            tic_patterns* ptrns = &bank->music.patterns;
+            LOAD_CHUNK(*ptrns, CHUNK_PATTERNS_DEP, i);
+            for(s32 p = 0; p < MUSIC_PATTERNS; p++)
+                for(s32 r = 0; r < MUSIC_PATTERN_ROWS; r++)
+                {
+                    tic_track_row* row = &ptrns->data[p].rows[r];
+                    if(row->note >= NoteStart && row->command == tic_music_cmd_empty)
+                    {
+                        row->command = tic_music_cmd_volume;
+                        row->param2 = row->param1 = MAX_VOLUME - row->param1;
+                    }
+                }
         }
 #endif
     }
 
-    struct CodeChunk {s32 size; const char* data;} code[TIC_BANKS] = {0};
-    struct BinaryChunk {s32 size; const u8* data;} binary[TIC_BINARY_BANKS] = {0};
+#if defined(BUILD_DEPRECATED)
+    // workaround to support ancient carts without palette
+    // load DB16 palette if it not exists
+    if (EMPTY(cart->bank0.palette.vbank0.data))
+        memcpy(cart->bank0.palette.vbank0.data, DB16, sizeof DB16);
 
     {
-        const u8* ptr = buffer;
-        while(ptr < end)
-        {
-            const Chunk* chunk = (Chunk*)ptr;
-            ptr += sizeof(Chunk);
+        // workaround to load deprecated cover section
+        const ChunkRef* chunk = CHUNK(CHUNK_COVER_DEP, 0);
+        gif_image* image = chunk->data ? gif_read_data(chunk->data, chunk->size) : NULL;
 
-            switch(chunk->type)
+        if (image)
+        {
+            if(image->width == TIC80_WIDTH && image->height == TIC80_HEIGHT)
             {
-            case CHUNK_TILES:       LOAD_CHUNK(cart->banks[chunk->bank].tiles);             break;
-            case CHUNK_SPRITES:     LOAD_CHUNK(cart->banks[chunk->bank].sprites);           break;
-            case CHUNK_MAP:         LOAD_CHUNK(cart->banks[chunk->bank].map);               break;
-            case CHUNK_SAMPLES:     LOAD_CHUNK(cart->banks[chunk->bank].sfx.samples);       break;
-            case CHUNK_WAVEFORM:    LOAD_CHUNK(cart->banks[chunk->bank].sfx.waveforms);     break;
-            case CHUNK_MUSIC:       LOAD_CHUNK(cart->banks[chunk->bank].music.tracks);      break;
-            case CHUNK_PATTERNS:    LOAD_CHUNK(cart->banks[chunk->bank].music.patterns);    break;
-            case CHUNK_FLAGS:       LOAD_CHUNK(cart->banks[chunk->bank].flags);             break;
-            case CHUNK_SCREEN:      LOAD_CHUNK(cart->banks[chunk->bank].screen);            break;
-            case CHUNK_LANG:        LOAD_CHUNK(cart->lang);                                 break;
-            case CHUNK_BINARY:
-                binary[chunk->bank] = (struct BinaryChunk){chunkSize(chunk), ptr};
-                break;
-            case CHUNK_CODE:
-                code[chunk->bank] = (struct CodeChunk){chunkSize(chunk), (char*)ptr};
-                break;
-#if defined(BUILD_DEPRECATED)
-            case CHUNK_CODE_ZIP:
-                tic_tool_unzip(cart->code.data, TIC_CODE_SIZE, ptr, retro_le_to_cpu16(chunk->size));
-                break;
-            case CHUNK_COVER_DEP:
-                {
-                    // workaround to load deprecated cover section
-                    gif_image* image = gif_read_data(ptr, retro_le_to_cpu16(chunk->size));
-
-                    if (image)
-                    {
-                        if(image->width == TIC80_WIDTH && image->height == TIC80_HEIGHT)
-                            for (s32 i = 0; i < TIC80_WIDTH * TIC80_HEIGHT; i++)
-                                tic_tool_poke4(cart->bank0.screen.data, i,
-                                    tic_nearest_color(cart->bank0.palette.vbank0.colors, (const tic_rgb*)&image->palette[image->buffer[i]], TIC_PALETTE_SIZE));
+                // map every gif color once instead of every pixel
+                u8 map[256] = {0};
+                for(s32 i = 0; i < MIN(image->colors, COUNT_OF(map)); i++)
+                    map[i] = tic_nearest_color(cart->bank0.palette.vbank0.colors, (const tic_rgb*)&image->palette[i], TIC_PALETTE_SIZE);
 
-                        gif_close(image);
-                    }
-                }
-                break;
-            case CHUNK_PATTERNS_DEP:
-                {
-                    // workaround to load deprecated music patterns section
-                    // and automatically convert volume value to a command
-                    tic_patterns* ptrns = &cart->banks[chunk->bank].music.patterns;
-                    LOAD_CHUNK(*ptrns);
-                    for(s32 i = 0; i < MUSIC_PATTERNS; i++)
-                        for(s32 r = 0; r < MUSIC_PATTERN_ROWS; r++)
-                        {
-                            tic_track_row* row = &ptrns->data[i].rows[r];
-                            if(row->note >= NoteStart && row->command == tic_music_cmd_empty)
-                            {
-                                row->command = tic_music_cmd_volume;
-                                row->param2 = row->param1 = MAX_VOLUME - row->param1;
-                            }
-                        }
-                }
-                break;
-#endif
-            default: break;
+                for (s32 i = 0; i < TIC80_WIDTH * TIC80_HEIGHT; i++)
+                    tic_tool_poke4(cart->bank0.screen.data, i, map[image->buffer[i]]);
             }
 
-            ptr += chunkSize(chunk);
+            gif_close(image);
         }
-#undef LOAD_CHUNK
+    }
+#endif
 
-        {
-            u32 total_size = 0;
-            char* ptr = cart->binary.data;
-            RFOR(const struct BinaryChunk*, chunk, binary)
-                if (chunk->size)
-                {
-                    memcpy(ptr, chunk->data, chunk->size);
-                    ptr += chunk->size;
-                    total_size += chunk->size;
-                }
-            cart->binary.size = total_size;
-        }
+    {
+        s32 total = 0;
+
+#if defined(BUILD_DEPRECATED)
+        const ChunkRef* zip = CHUNK(CHUNK_CODE_ZIP, 0);
+        if(zip->data)
+            total = tic_tool_unzip(cart->code.data, TIC_CODE_SIZE, zip->data, zip->size);
 
-        if (!*cart->code.data)
+        if(!total || !*cart->code.data)
+#endif
         {
-            char* ptr = cart->code.data;
-            RFOR(const struct CodeChunk*, chunk, code)
+            total = 0;
+            RFOR(const ChunkRef*, chunk, index.chunks[CHUNK_CODE])
                 if (chunk->data)
                 {
-                    memcpy(ptr, chunk->data, chunk->size);
-                    ptr += chunk->size;
+                    memcpy(cart->code.data + total, chunk->data, chunk->size);
+                    total += chunk->size;
                 }
         }
+
+        memset(cart->code.data + total, 0, TIC_CODE_SIZE - total);
     }
+
+    {
+        s32 total = 0;
+        const ChunkRef* binary = index.chunks[CHUNK_BINARY];
+
+        for(s32 i = TIC_BINARY_BANKS - 1; i >= 0; i--)
+            if (binary[i].data)
+            {
+                memcpy(cart->binary.data + total, binary[i].data, binary[i].size);
+                total += binary[i].size;
+            }
+
+        memset(cart->binary.data + total, 0, TIC_BINARY_SIZE - total);
+        cart->binary.size = total;
+    }
+
+    // lang and the padding after it
+    memset(&cart->lang, 0, sizeof(tic_cartridge) - offsetof(tic_cartridge, lang));
+    LOAD_CHUNK(cart->lang, CHUNK_LANG, 0);
+
+#undef LOAD_CHUNK
+#undef CHUNK
+
     // if we have allocated the buffer from a PNG chunk
     if (chunk_cart)
         free(chunk_cart);
 }
 
 
+struct tic_cart_reader
+{
+    ChunkIndex index;
+
+    const u8* data;     // chunk stream
+    s32 size;           // bytes of the stream we have so far
+    s32 pos;            // chunks before pos are indexed
+
+    // PNG carts are inflated only as far as needed
+    png_buffer zip; // decoded from pixels, NULL if read from the cart chunk
+    tic_unzip* unzip;
+    u8* buffer;
+
+    char* code;
+};
+
+tic_cart_reader* tic_cart_reader_open(const u8* buffer, s32 size)
+{
+    tic_cart_reader* reader = calloc(1, sizeof(tic_cart_reader));
+
+    if(!reader)
+        return NULL;
+
+    if (size >= 4 && !memcmp(buffer, "\x89PNG", 4))
+    {
+        png_buffer png = {.data = (u8*)buffer, .size = size};
+        png_buffer zip = png_cart(png);
+
+        if(!zip.size)
+            zip = reader->zip = png_decode(png);
+
+        if(zip.size)
+        {
+            reader->unzip = tic_tool_unzip_open(zip.data, zip.size);
+            reader->data = reader->buffer = malloc(sizeof(tic_cartridge));
+        }
+
+        if(!reader->unzip || !reader->buffer)
+        {
+            tic_cart_reader_close(reader);
+            return NULL;
+        }
+    }
+    else
+    {
+        reader->data = buffer;
+        reader->size = size;
+    }
+
+    return reader;
+}
+
+void tic_cart_reader_close(tic_cart_reader* reader)
+{
+    if(reader->unzip)
+        tic_tool_unzip_close(reader->unzip);
+
+    FREE(reader->zip.data);
+    FREE(reader->buffer);
+    FREE(reader->code);
+    free(reader);
+}
+
+static bool readMore(tic_cart_reader* reader)
+{
+    enum {Step = 16 * 1024};
+
+    if(reader->unzip)
+    {
+        s32 size = tic_tool_unzip_read(reader->unzip, reader->buffer + reader->size,
+            MIN(Step, (s32)sizeof(tic_cartridge) - reader->size));
+
+        if(size > 0)
+        {
+            reader->size += size;
+            return true;
+        }
+
+        tic_tool_unzip_close(reader->unzip);
+        reader->unzip = NULL;
+    }
+
+    return false;
+}
+
+static bool hasChunk(const tic_cart_reader* reader, u32 types, s32 bank)
+{
+    for(s32 t = 0; t < COUNT_OF(reader->index.chunks); t++)
+        if(types & (1u << t))
+            for(s32 b = 0; b < TIC_BANKS; b++)
+                if((bank < 0 || bank == b) && reader->index.chunks[t][b].data)
+                    return true;
+
+    return false;
+}
+
+// index the stream until a chunk of the given types shows up,
+// bank < 0 means any bank
+static bool findChunk(tic_cart_reader* reader, u32 types, s32 bank)
+{
+    do
+    {
+        reader->pos += indexChunks(&reader->index, reader->data + reader->pos, reader->size - reader->pos);
+
+        if(hasChunk(reader, types, bank))
+            return true;
+    }
+    while(readMore(reader));
+
+    return false;
+}
+
+bool tic_cart_read_palette(tic_cart_reader* reader, s32 bank, tic_palettes* palette)
+{
+    if(bank < 0 || bank >= TIC_BANKS)
+        return false;
+
+    if(!findChunk(reader, 1u << CHUNK_PALETTE | 1u << CHUNK_DEFAULT, bank))
+    {
+#if defined(BUILD_DEPRECATED)
+        // ancient carts without palette use DB16
+        if(bank == 0)
+        {
+            memset(palette, 0, sizeof(tic_palettes));
+            memcpy(palette, DB16, sizeof DB16);
+            return true;
+        }
+#endif
+        return false;
+    }
+
+    const ChunkRef* chunk = &reader->index.chunks[CHUNK_PALETTE][bank];
+
+    loadSection(palette, sizeof(tic_palettes), chunk);
+
+    if(!chunk->data)
+        memcpy(palette, Sweetie16, sizeof Sweetie16);
+
+    return true;
+}
+
+bool tic_cart_read_screen(tic_cart_reader* reader, s32 bank, tic_screen* screen)
+{
+    if(bank < 0 || bank >= TIC_BANKS || !findChunk(reader, 1u << CHUNK_SCREEN, bank))
+        return false;
+
+    loadSection(screen, sizeof(tic_screen), &reader->index.chunks[CHUNK_SCREEN][bank]);
+
+    return true;
+}
+
+const char* tic_cart_read_metatag(tic_cart_reader* reader, const char* tag, const char* comment)
+{
+    if(!reader->code)
+    {
+        if(!findChunk(reader, 1u << CHUNK_CODE, -1))
+            return "";
+
+        // code is saved from the last bank down, so the last bank holds the head
+        RFOR(const ChunkRef*, chunk, reader->index.chunks[CHUNK_CODE])
+            if(chunk->data)
+            {
+                reader->code = malloc(chunk->size + 1);
+                memcpy(reader->code, chunk->data, chunk->size);
+                reader->code[chunk->size] = '\0';
+                break;
+            }
+    }
+
+    return tic_tool_metatag(reader->code, tag, comment);
+}
+
 static s32 calcBufferSize(const void* buffer, s32 size)
 {
-    const u8* ptr = (u8*)buffer + size - 1;
-    const u8* end = (u8*)buffer;
+    const u8* ptr = buffer;
 
-    while(ptr >= end)
+    // most sections end with a long run of zeros, skip it a word at a time
+    for(u64 word; size >= sizeof word; size -= sizeof word)
     {
-        if(*ptr) break;
+        memcpy(&word, ptr + size - sizeof word, sizeof word);
+        if(word) break;
+    }
 
-        ptr--;
+    while(size && !ptr[size - 1])
         size--;
-    }
 
     return size;
 }
 
-static u8* saveFixedChunk(u8* buffer, ChunkType type, const void* from, s32 size, s32 bank)
+// the cart is emitted chunk by chunk, the writer decides where the bytes go
+typedef struct
+{
+    void(*chunk)(void* data, const Chunk* chunk, const void* from, s32 size);
+    void* data;
+} CartWriter;
+
+static void saveFixedChunk(const CartWriter* writer, ChunkType type, const void* from, s32 size, s32 bank)
 {
     if(size)
     {
         Chunk chunk = {.type = type, .bank = bank, .size = retro_le_to_cpu16(size), .temp = 0};
-        memcpy(buffer, &chunk, sizeof(Chunk));
-        buffer += sizeof(Chunk);
-
-        memcpy(buffer, from, size);
-        buffer += size;
+        writer->chunk(writer->data, &chunk, from, size);
     }
-
-    return buffer;
 }
 
-static u8* saveChunk(u8* buffer, ChunkType type, const void* from, s32 size, s32 bank)
+static void saveChunk(const CartWriter* writer, ChunkType type, const void* from, s32 size, s32 bank)
 {
     s32 chunkSize = calcBufferSize(from, size);
 
-    return saveFixedChunk(buffer, type, from, chunkSize, bank);
+    saveFixedChunk(writer, type, from, chunkSize, bank);
 }
 
-s32 tic_cart_save(const tic_cartridge* cart, u8* buffer)
+static void saveCart(const tic_cartridge* cart, const CartWriter* writer)
 {
-    u8* start = buffer;
-
-#define SAVE_CHUNK(ID, FROM, BANK) saveChunk(buffer, ID, &FROM, sizeof(FROM), BANK)
+#define SAVE_CHUNK(ID, FROM, BANK) saveChunk(writer, ID, &FROM, sizeof(FROM), BANK)
 
     tic_waveforms defaultWaveforms = {0};
     tic_palettes defaultPalettes = {0};
@@ -336,23 +558,22 @@ s32 tic_cart_save(const tic_cartridge* cart, u8* buffer)
             && memcmp(&cart->banks[i].palette, &defaultPalettes, sizeof defaultPalettes) == 0)
         {
             Chunk chunk = {.type = CHUNK_DEFAULT, .bank = i, .size = 0, .temp = 0};
-            memcpy(buffer, &chunk, sizeof chunk);
-            buffer += sizeof chunk;
+            writer->chunk(writer->data, &chunk, NULL, 0);
         }
         else
         {
-            buffer = SAVE_CHUNK(CHUNK_PALETTE, cart->banks[i].palette, i);
-            buffer = SAVE_CHUNK(CHUNK_WAVEFORM, cart->banks[i].sfx.waveforms, i);
+            SAVE_CHUNK(CHUNK_PALETTE, cart->banks[i].palette, i);
+            SAVE_CHUNK(CHUNK_WAVEFORM, cart->banks[i].sfx.waveforms, i);
         }
 
-        buffer = SAVE_CHUNK(CHUNK_TILES,    cart->banks[i].tiles,           i);
-        buffer = SAVE_CHUNK(CHUNK_SPRITES,  cart->banks[i].sprites,         i);
-        buffer = SAVE_CHUNK(CHUNK_MAP,      cart->banks[i].map,             i);
-        buffer = SAVE_CHUNK(CHUNK_SAMPLES,  cart->banks[i].sfx.samples,     i);
-        buffer = SAVE_CHUNK(CHUNK_PATTERNS, cart->banks[i].music.patterns,  i);
-        buffer = SAVE_CHUNK(CHUNK_MUSIC,    cart->banks[i].music.tracks,    i);
-        buffer = SAVE_CHUNK(CHUNK_FLAGS,    cart->banks[i].flags,           i);
-        buffer = SAVE_CHUNK(CHUNK_SCREEN,   cart->banks[i].screen,          i);
+        SAVE_CHUNK(CHUNK_TILES,    cart->banks[i].tiles,           i);
+        SAVE_CHUNK(CHUNK_SPRITES,  cart->banks[i].sprites,         i);
+        SAVE_CHUNK(CHUNK_MAP,      cart->banks[i].map,             i);
+        SAVE_CHUNK(CHUNK_SAMPLES,  cart->banks[i].sfx.samples,     i);
+        SAVE_CHUNK(CHUNK_PATTERNS, cart->banks[i].music.patterns,  i);
+        SAVE_CHUNK(CHUNK_MUSIC,    cart->banks[i].music.tracks,    i);
+        SAVE_CHUNK(CHUNK_FLAGS,    cart->banks[i].flags,           i);
+        SAVE_CHUNK(CHUNK_SCREEN,   cart->banks[i].screen,          i);
     }
 
     const char* ptr;
@@ -362,19 +583,112 @@ s32 tic_cart_save(const tic_cartridge* cart, u8* buffer)
         s32 remaining = cart->binary.size;
         for (s32 i = cart->binary.size / TIC_BANK_SIZE; i >= 0; --i, ptr += TIC_BANK_SIZE)
         {
-            buffer = saveFixedChunk(buffer, CHUNK_BINARY, ptr, MIN(remaining, TIC_BANK_SIZE), i);
+            saveFixedChunk(writer, CHUNK_BINARY, ptr, MIN(remaining, TIC_BANK_SIZE), i);
             remaining -= TIC_BANK_SIZE;
         }
     }
 
     ptr = cart->code.data;
     for(s32 i = strlen(ptr) / TIC_BANK_SIZE; i >= 0; --i, ptr += TIC_BANK_SIZE)
-        buffer = saveFixedChunk(buffer, CHUNK_CODE, ptr, MIN(strlen(ptr), TIC_BANK_SIZE), i);
+        saveFixedChunk(writer, CHUNK_CODE, ptr, MIN(strlen(ptr), TIC_BANK_SIZE), i);
 
     if(cart->lang)
         SAVE_CHUNK(CHUNK_LANG, cart->lang, 0);
 
 #undef SAVE_CHUNK
+}
+
+static void writeBuffer(void* data, const Chunk* chunk, const void* from, s32 size)
+{
+    u8** buffer = data;
+
+    memcpy(*buffer, chunk, sizeof(Chunk));
+    *buffer += sizeof(Chunk);
+
+    memcpy(*buffer, from, size);
+    *buffer += size;
+}
+
+s32 tic_cart_save(const tic_cartridge* cart, u8* buffer)
+{
+    u8* ptr = buffer;
+    saveCart(cart, &(CartWriter){writeBuffer, &ptr});
+
+    return (s32)(ptr - buffer);
+}
+
+static void writeZip(void* data, const Chunk* chunk, const void* from, s32 size)
+{
+    tic_zip* zip = data;
+
+    tic_tool_zip_write(zip, chunk, sizeof(Chunk));
+    tic_tool_zip_write(zip, from, size);
+}
+
+s32 tic_cart_save_zip(const tic_cartridge* cart, void* buffer, s32 size, s32 level)
+{
+    tic_zip* zip = tic_tool_zip_open(buffer, size, level);
+
+    if(!zip)
+        return 0;
+
+    saveCart(cart, &(CartWriter){writeZip, zip});
+
+    return tic_tool_zip_close(zip);
+}
+
+// every chunk is compressed on its own and remembered by its hash,
+// so only the sections changed since the last call are compressed again
+typedef struct
+{
+    u64 hash;
+    s32 size;
+    s32 zipSize;
+} SizerChunk;
+
+struct tic_cart_sizer
+{
+    SizerChunk chunks[1 << 5][TIC_BANKS];
+    s32 total;
+};
+
+tic_cart_sizer* tic_cart_sizer_create()
+{
+    return calloc(1, sizeof(tic_cart_sizer));
+}
+
+void tic_cart_sizer_close(tic_cart_sizer* sizer)
+{
+    free(sizer);
+}
+
+static void writeSizer(void* data, const Chunk* chunk, const void* from, s32 size)
+{
+    tic_cart_sizer* sizer = data;
+    SizerChunk* cached = &sizer->chunks[chunk->type][chunk->bank];
+
+    u64 hash = tic_tool_hash(from, size, TIC_HASH_SEED);
+
+    if(cached->zipSize == 0 || cached->size != size || cached->hash != hash)
+    {
+        tic_zip* zip = tic_tool_zip_open(NULL, 0, TIC_ZIP_FAST);
+
+        if(zip)
+        {
+            tic_tool_zip_write(zip, chunk, sizeof(Chunk));
+            tic_tool_zip_write(zip, from, size);
+
+            *cached = (SizerChunk){hash, size, tic_tool_zip_close(zip)};
+        }
+    }
+
+    sizer->total += cached->zipSize;
+}
+
+s32 tic_cart_sizer_estimate(tic_cart_sizer* sizer, const tic_cartridge* cart)
+{
+    sizer->total = 0;
+    saveCart(cart, &(CartWriter){writeSizer, sizer});
 
-    return (s32)(buffer - start);
+    return sizer->total;
 }
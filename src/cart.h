@@ -26,3 +26,24 @@
 
 void tic_cart_load(tic_cartridge* rom, const u8* buffer, s32 size);
 s32  tic_cart_save(const tic_cartridge* rom, u8* buffer);
+
+// save and deflate in one pass, returns 0 if it doesn't fit the buffer
+s32  tic_cart_save_zip(const tic_cartridge* cart, void* buffer, s32 size, s32 level);
+
+// guess the zipped cart size, cheap to call again after small edits
+typedef struct tic_cart_sizer tic_cart_sizer;
+
+tic_cart_sizer* tic_cart_sizer_create();
+s32 tic_cart_sizer_estimate(tic_cart_sizer* sizer, const tic_cartridge* cart);
+void tic_cart_sizer_close(tic_cart_sizer* sizer);
+
+// read separate sections without loading the whole cart,
+// the buffer has to outlive the reader
+typedef struct tic_cart_reader tic_cart_reader;
+
+tic_cart_reader* tic_cart_reader_open(const u8* buffer, s32 size);
+void tic_cart_reader_close(tic_cart_reader* reader);
+
+bool tic_cart_read_palette(tic_cart_reader* reader, s32 bank, tic_palettes* palette);
+bool tic_cart_read_screen(tic_cart_reader* reader, s32 bank, tic_screen* screen);
+const char* tic_cart_read_metatag(tic_cart_reader* reader, const char* tag, const char* comment);
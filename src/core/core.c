@@ -25,6 +25,7 @@
 
 #include "api.h"
 #include "core.h"
+#include "cart.h"
 #include "tilesheet.h"
 
 #include <assert.h>
@@ -86,6 +87,9 @@ void tic_api_poke(tic_mem* memory, s32 address, u8 value, s32 bits)
     case 4: if(address < RamBits / 4) tic_tool_poke4(ram, address, value); break;
     case 8: if(address < RamBits / 8) ram[address] = value; break;
     }
+
+    if(address < (s32)sizeof(tic_vram) * BITS_IN_BYTE / bits)
+        core->blitted.dirty = true;
 }
 
 u8 tic_api_peek4(tic_mem* memory, s32 address)
@@ -132,6 +136,9 @@ void tic_api_memcpy(tic_mem* memory, s32 dst, s32 src, s32 size)
     {
         u8* base = (u8*)memory->ram;
         memmove(base + dst, base + src, size);
+
+        if(dst < sizeof(tic_vram))
+            core->blitted.dirty = true;
     }
 }
 
@@ -147,6 +154,9 @@ void tic_api_memset(tic_mem* memory, s32 dst, u8 val, s32 size)
     {
         u8* base = (u8*)memory->ram;
         memset(base + dst, val, size);
+
+        if(dst < sizeof(tic_vram))
+            core->blitted.dirty = true;
     }
 }
 
@@ -209,12 +219,14 @@ void tic_api_sync(tic_mem* tic, u32 mask, s32 bank, bool toCart)
 
     assert(bank >= 0 && bank < TIC_BANKS);
 
+    // writing back to a shared cart detaches this instance from it
+    tic_bank* bankPtr = &(toCart && mask ? tic_core_cart_own(tic) : tic->cart)->banks[bank];
+
     for (s32 i = 0; i < Count; i++)
     {
         u32 sectionMask = Sections[i].mask;
         if(mask & sectionMask)
         {
-            tic_bank* bankPtr = &tic->cart.banks[bank];
             s32 size = Sections[i].size;
 
             if(sectionMask == tic_sync_palette)
@@ -232,25 +244,46 @@ void tic_api_sync(tic_mem* tic, u32 mask, s32 bank, bool toCart)
         }
     }
 
+    if(!toCart && (mask & tic_sync_screen))
+        core->blitted.dirty = true;
+
     core->state.synced |= mask;
 }
 
 double tic_api_time(tic_mem* memory)
 {
     tic_core* core = (tic_core*)memory;
-    return (double)(core->data->counter(core->data->data) - core->data->start) * 1000.0 / core->data->freq(core->data->data);
+    const tic80_clock* clock = &core->data->clock;
+
+    switch(clock->mode)
+    {
+    case TIC80_CLOCK_FRAMES:
+        return core->state.frame * 1000.0 / TIC80_FRAMERATE;
+    case TIC80_CLOCK_HOST:
+        return clock->time;
+    default:
+        return (double)(core->data->counter(core->data->data) - core->data->start) * 1000.0 / core->data->freq(core->data->data);
+    }
 }
 
 s32 tic_api_tstamp(tic_mem* memory)
 {
     tic_core* core = (tic_core*)memory;
+    const tic80_clock* clock = core->data ? &core->data->clock : NULL;
+
+    if(clock && clock->mode == TIC80_CLOCK_FRAMES)
+        return clock->tstamp + core->state.frame / TIC80_FRAMERATE;
+
+    if(clock && clock->mode == TIC80_CLOCK_HOST)
+        return clock->tstamp;
+
     return (s32)time(NULL);
 }
 
 static void updateSaveid(tic_mem* memory)
 {
     memset(memory->saveid, 0, sizeof memory->saveid);
-    const char* saveid = tic_tool_metatag(memory->cart.code.data, "saveid", NULL);
+    const char* saveid = tic_tool_metatag(memory->cart->code.data, "saveid", NULL);
     if (*saveid)
     {
         strncpy(memory->saveid, saveid, TIC_SAVEID_SIZE - 1);
@@ -294,7 +327,7 @@ static void resetVbank(tic_mem* memory)
 
     static const u8 DefaultMapping[] = { 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe };
     memcpy(memory->ram->vram.mapping, DefaultMapping, sizeof DefaultMapping);
-    memory->ram->vram.palette = memory->cart.bank0.palette.vbank0;
+    memory->ram->vram.palette = memory->cart->bank0.palette.vbank0;
     memory->ram->vram.blit.segment = TIC_DEFAULT_BLIT_MODE;
 }
 
@@ -382,7 +415,182 @@ static void cart2ram(tic_mem* memory)
     };
 
     // don't sync empty screen
-    tic_api_sync(memory, EMPTY(memory->cart.bank0.screen.data) ? noscreen : all, 0, false);
+    tic_api_sync(memory, EMPTY(memory->cart->bank0.screen.data) ? noscreen : all, 0, false);
+}
+
+static void vmLink(tic_core* core, tic_vm_chunk* chunk)
+{
+    chunk->prev = NULL;
+    chunk->next = core->arena.chunks;
+
+    if(chunk->next)
+        chunk->next->prev = chunk;
+
+    core->arena.chunks = chunk;
+}
+
+static void vmUnlink(tic_core* core, tic_vm_chunk* chunk)
+{
+    if(chunk->prev)
+        chunk->prev->next = chunk->next;
+    else
+        core->arena.chunks = chunk->next;
+
+    if(chunk->next)
+        chunk->next->prev = chunk->prev;
+}
+
+static inline bool vmSmall(size_t size)
+{
+    return size <= TIC_VM_SMALL_SIZE;
+}
+
+// what a block takes from the arena, small ones are rounded up to their class
+static inline size_t vmFit(size_t size)
+{
+    return vmSmall(size) ? (size + TIC_VM_ALIGN - 1) & ~(size_t)(TIC_VM_ALIGN - 1) : size;
+}
+
+static void* vmTake(tic_core* core, size_t size)
+{
+    size_t fit = vmFit(size);
+
+    if(vmSmall(size))
+    {
+        void** list = &core->arena.free[fit / TIC_VM_ALIGN - 1];
+
+        if(*list)
+        {
+            void* ptr = *list;
+            *list = *(void**)ptr;
+            core->arena.used += fit;
+            return ptr;
+        }
+
+        // the tail of a full chunk is left unused
+        if(core->arena.end - core->arena.top < (ptrdiff_t)fit)
+        {
+            tic_vm_chunk* chunk = malloc(sizeof(tic_vm_chunk) + TIC_VM_CHUNK_SIZE);
+
+            if(!chunk)
+                return NULL;
+
+            vmLink(core, chunk);
+            core->arena.top = (u8*)(chunk + 1);
+            core->arena.end = core->arena.top + TIC_VM_CHUNK_SIZE;
+        }
+
+        void* ptr = core->arena.top;
+        core->arena.top += fit;
+        core->arena.used += fit;
+        return ptr;
+    }
+
+    tic_vm_chunk* chunk = malloc(sizeof(tic_vm_chunk) + size);
+
+    if(!chunk)
+        return NULL;
+
+    vmLink(core, chunk);
+    core->arena.used += size;
+    return chunk + 1;
+}
+
+static void vmDrop(tic_core* core, void* ptr, size_t size)
+{
+    size_t fit = vmFit(size);
+
+    if(vmSmall(size))
+    {
+        void** list = &core->arena.free[fit / TIC_VM_ALIGN - 1];
+        *(void**)ptr = *list;
+        *list = ptr;
+    }
+    else
+    {
+        tic_vm_chunk* chunk = (tic_vm_chunk*)ptr - 1;
+        vmUnlink(core, chunk);
+        free(chunk);
+    }
+
+    core->arena.used -= fit;
+}
+
+static void* vmRealloc(tic_mem* memory, void* ptr, size_t osize, size_t nsize)
+{
+    tic_core* core = (tic_core*)memory;
+
+    // Lua tells the object type in osize of a new block
+    if(!ptr)
+        osize = 0;
+
+    if(nsize == 0)
+    {
+        if(ptr)
+            vmDrop(core, ptr, osize);
+
+        return NULL;
+    }
+
+    size_t ofit = ptr ? vmFit(osize) : 0;
+    size_t nfit = vmFit(nsize);
+
+    if(ptr && vmSmall(osize) && vmSmall(nsize) && ofit == nfit)
+        return ptr;
+
+    // shrinking never fails, Lua relies on it
+    if(nfit > ofit && core->arena.used - ofit + nfit > core->arena.limit)
+        return NULL;
+
+    void* next = NULL;
+
+    if(ptr && !vmSmall(osize) && !vmSmall(nsize))
+    {
+        tic_vm_chunk* chunk = (tic_vm_chunk*)ptr - 1;
+        vmUnlink(core, chunk);
+
+        tic_vm_chunk* grown = realloc(chunk, sizeof(tic_vm_chunk) + nsize);
+        vmLink(core, grown ? grown : chunk);
+
+        if(!grown)
+            return nsize > osize ? NULL : ptr;
+
+        core->arena.used += nsize - osize;
+        next = grown + 1;
+    }
+    else
+    {
+        next = vmTake(core, nsize);
+
+        if(!next)
+            return nsize > osize ? NULL : ptr;
+
+        if(ptr)
+        {
+            memcpy(next, ptr, MIN(osize, nsize));
+            vmDrop(core, ptr, osize);
+        }
+    }
+
+    core->arena.peak = MAX(core->arena.peak, core->arena.used);
+
+    return next;
+}
+
+static void vmRelease(tic_mem* memory)
+{
+    tic_core* core = (tic_core*)memory;
+
+    for(tic_vm_chunk *chunk = core->arena.chunks, *next; chunk; chunk = next)
+    {
+        next = chunk->next;
+        free(chunk);
+    }
+
+    core->arena.chunks = NULL;
+    core->arena.top = core->arena.end = NULL;
+    ZEROMEM(core->arena.free);
+    core->arena.used = core->arena.peak = 0;
 }
 
 static void tic_close_current_vm(tic_core* core)
@@ -394,9 +602,62 @@ static void tic_close_current_vm(tic_core* core)
         core->currentScript->close( (tic_mem*)core );
         core->currentVM = NULL;
     }
-    if (core->memory.ram == NULL) {
-        core->memory.ram = core->memory.base_ram;
+
+    // free whatever the VM didn't
+    vmRelease((tic_mem*)core);
+}
+
+// the VM state is broken after a panic, don't let the runtime walk it
+static void vmPanic(tic_core* core)
+{
+    core->currentVM = NULL;
+    vmRelease((tic_mem*)core);
+}
+
+#define VM_PROTECT(CORE, ...)                       \
+do{                                                 \
+    jmp_buf jump, *prev = (CORE)->panic;            \
+    if(setjmp(jump) == 0)                           \
+    {                                               \
+        (CORE)->panic = &jump;                      \
+        __VA_ARGS__;                                \
+    }                                               \
+    else vmPanic(CORE);                             \
+    (CORE)->panic = prev;                           \
+}while(0)
+
+static bool tic_init_vm_bytecode(tic_core* core, const char* code, const tic_script* config)
+{
+    tic_mem* tic = (tic_mem*)core;
+    tic_tick_data* data = core->data;
+
+    u64 hash = tic_tool_hash(config->name, (s32)strlen(config->name), TIC_HASH_SEED);
+    if(config->bytecode.version)
+        hash = tic_tool_hash(config->bytecode.version, (s32)strlen(config->bytecode.version), hash);
+    hash = tic_tool_hash(code, (s32)strlen(code), hash);
+
+    char key[64];
+    snprintf(key, sizeof key, "%s-%08x%08x", config->name, (u32)(hash >> 32), (u32)hash);
+
+    s32 size = 0;
+    void* buffer = data->cache.load(data->data, key, &size);
+
+    if(!buffer)
+    {
+        buffer = config->bytecode.compile(tic, code, &size);
+
+        // let init report the compilation error
+        if(!buffer)
+            return config->init(tic, code);
+
+        if(data->cache.save)
+            data->cache.save(data->data, key, buffer, size);
     }
+
+    bool done = config->bytecode.load(tic, buffer, size);
+    free(buffer);
+
+    return done;
 }
 
 static bool tic_init_vm(tic_core* core, const char* code, const tic_script* config)
@@ -405,7 +666,9 @@ static bool tic_init_vm(tic_core* core, const char* code, const tic_script* conf
     // set current script config and init
     core->currentScript = config;
 
-    bool done = config->init((tic_mem*)core, code);
+    bool done = config->bytecode.load && core->data->cache.load
+        ? tic_init_vm_bytecode(core, code, config)
+        : config->init((tic_mem*)core, code);
     if(!done)
     {
         // if it couldn't init, make sure the VM is not left dirty by the implementation
@@ -415,6 +678,20 @@ static bool tic_init_vm(tic_core* core, const char* code, const tic_script* conf
     return done;
 }
 
+void tic_core_seed(tic_mem* memory, u32 seed)
+{
+    tic_core* core = (tic_core*)memory;
+
+    core->seed.value = seed;
+    core->seed.set = true;
+
+    // for the runtimes that take their numbers from the C library
+    srand(seed);
+
+    if(core->currentVM && core->currentScript->seed)
+        core->currentScript->seed(memory, seed);
+}
+
 s32 tic_api_vbank(tic_mem* tic, s32 bank)
 {
     tic_core* core = (tic_core*)tic;
@@ -435,19 +712,17 @@ s32 tic_api_vbank(tic_mem* tic, s32 bank)
     return prev;
 }
 
-void tic_core_tick(tic_mem* tic, tic_tick_data* data)
+static void coreTick(tic_mem* tic, tic_tick_data* data)
 {
     tic_core* core = (tic_core*)tic;
 
-    core->data = data;
-
     if (fftEnabled)
     {
         FFT_GetFFT(fftData);
     }
     if (!core->state.initialized)
     {
-        const char* code = tic->cart.code.data;
+        const char* code = tic->cart->code.data;
 
         bool done = false;
         const tic_script* config = tic_get_script(tic);
@@ -470,7 +745,7 @@ void tic_core_tick(tic_mem* tic, tic_tick_data* data)
             data->start = data->counter(core->data->data);
 
             if (config->useBinarySection)
-                code = tic->cart.binary.data;
+                code = tic->cart->binary.data;
 
             done = tic_init_vm(core, code, config);
         }
@@ -490,6 +765,113 @@ void tic_core_tick(tic_mem* tic, tic_tick_data* data)
     }
 
     core->state.tick(tic);
+    core->state.frame++;
+}
+
+void tic_core_tick(tic_mem* tic, tic_tick_data* data)
+{
+    tic_core* core = (tic_core*)tic;
+
+    core->data = data;
+
+    VM_PROTECT(core, coreTick(tic, data));
+}
+
+static inline u8* ramBlock(tic_mem* memory)
+{
+    return (u8*)memory->ram - TIC_RAM_HEADER_SIZE;
+}
+
+static void updateSfxPos(tic_core* core)
+{
+    for (s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+        core->state.sfx.channels[i].pos = &core->memory.ram->sfxpos[i];
+}
+
+bool tic_core_ram_resize(tic_mem* memory, s32 size)
+{
+    tic_core* core = (tic_core*)memory;
+
+    size = MAX(size, TIC_RAM_SIZE);
+
+    if(size == core->ramsize)
+        return true;
+
+    u8* block = realloc(ramBlock(memory), TIC_RAM_HEADER_SIZE + size);
+
+    if(!block)
+        return false;
+
+    memory->ram = (tic_ram*)(block + TIC_RAM_HEADER_SIZE);
+
+    if(size > core->ramsize)
+        memset((u8*)memory->ram + core->ramsize, 0, size - core->ramsize);
+
+    core->ramsize = size;
+    updateSfxPos(core);
+
+    return true;
+}
+
+tic_vm_memory tic_core_vm_memory(tic_mem* memory)
+{
+    tic_core* core = (tic_core*)memory;
+
+    return (tic_vm_memory)
+    {
+        .used = (s32)core->arena.used,
+        .peak = (s32)core->arena.peak,
+        .limit = (s32)core->arena.limit,
+    };
+}
+
+void tic_core_vm_limit(tic_mem* memory, s32 limit)
+{
+    tic_core* core = (tic_core*)memory;
+    core->arena.limit = limit;
+}
+
+tic_gc_stats tic_core_gc(tic_mem* memory, double budget)
+{
+    tic_core* core = (tic_core*)memory;
+    const tic_script* script = core->currentScript;
+
+    tic_gc_stats stats = {0};
+
+    if(!core->state.initialized || !core->currentVM || !script->gc.step)
+        return stats;
+
+    tic_tick_data* data = core->data;
+    u64 freq = data->freq(data->data);
+    u64 start = data->counter(data->data);
+    u64 end = start + (u64)(budget * freq / 1000.0);
+    u64 now = start;
+
+    // collect in small steps until the cycle is done or the budget is spent,
+    // a step that took longer than what is left waits for a better frame
+    // and its cost is forgotten bit by bit, so it gets another try later
+    while(now < end)
+    {
+        if(core->gcstep > end - now)
+        {
+            core->gcstep -= core->gcstep / 8;
+            break;
+        }
+
+        bool done = script->gc.step(memory);
+        u64 prev = now;
+        now = data->counter(data->data);
+        core->gcstep = now - prev;
+
+        if(done) break;
+    }
+
+    stats.time = (double)(now - start) * 1000.0 / freq;
+
+    if(script->gc.heap)
+        stats.heap = script->gc.heap(memory);
+
+    return stats;
 }
 
 void tic_core_pause(tic_mem* memory)
@@ -515,6 +897,7 @@ void tic_core_resume(tic_mem* memory)
     {
         memcpy(&core->state, &core->pause.state, sizeof(tic_core_state_data));
         memcpy(memory->ram, &core->pause.ram, sizeof(tic_ram));
+        updateSfxPos(core);
         core->data->start = core->pause.time.start + core->data->counter(core->data->data) - core->pause.time.paused;
         memory->input.data = core->pause.input;
     }
@@ -524,6 +907,321 @@ void tic_core_resume(tic_mem* memory)
     }
 }
 
+#define TIC_STATE_MAGIC 0x53434954 // "TICS"
+#define TIC_STATE_VERSION 2
+
+// machine state is the header, the core state, the RAM block and the VM snapshot
+typedef struct
+{
+    u32 magic;
+    u32 version;
+    u64 ram;        // RAM address, the music pointers are moved by the difference
+    s32 ramsize;
+    s32 vmsize;
+    u8 lang;
+    u8 input;
+    bool initialized;
+} StateHeader;
+
+// -1 if the running VM can't be saved
+static s32 vmStateSize(tic_core* core)
+{
+    if(!core->state.initialized || !core->currentVM)
+        return 0;
+
+    const tic_script* script = core->currentScript;
+    return script->snapshot.size ? script->snapshot.size(&core->memory) : -1;
+}
+
+static u8 vmStateLang(tic_core* core)
+{
+    return core->state.initialized && core->currentScript ? core->currentScript->id : 0;
+}
+
+// the size doesn't follow the VM, it's the bound the cart's runtime reports,
+// so hosts see the same size before the first tick and after it
+s32 tic_core_state_size(tic_mem* memory)
+{
+    tic_core* core = (tic_core*)memory;
+    const tic_script* script = core->state.initialized && core->currentScript
+        ? core->currentScript
+        : tic_get_script(memory);
+
+    return script->snapshot.size
+        ? sizeof(StateHeader) + sizeof(tic_core_state_data) + script->snapshot.bound(memory)
+        : 0;
+}
+
+bool tic_core_state_save(tic_mem* memory, void* buffer, s32 size)
+{
+    tic_core* core = (tic_core*)memory;
+    s32 vmsize = vmStateSize(core);
+    s32 statesize = tic_core_state_size(memory);
+
+    if(vmsize < 0 || statesize == 0 || size < statesize)
+        return false;
+
+    s32 used = sizeof(StateHeader) + sizeof(tic_core_state_data) + core->ramsize + vmsize;
+
+    if(used > statesize)
+        return false;
+
+    StateHeader header =
+    {
+        .magic = TIC_STATE_MAGIC,
+        .version = TIC_STATE_VERSION,
+        .ram = (u64)(uintptr_t)memory->ram,
+        .ramsize = core->ramsize,
+        .vmsize = vmsize,
+        .lang = vmStateLang(core),
+        .input = memory->input.data,
+        .initialized = core->state.initialized,
+    };
+
+    u8* ptr = buffer;
+    memcpy(ptr, &header, sizeof header);
+    ptr += sizeof header;
+    memcpy(ptr, &core->state, sizeof(tic_core_state_data));
+    ptr += sizeof(tic_core_state_data);
+    memcpy(ptr, memory->ram, core->ramsize);
+    ptr += core->ramsize;
+
+    if(vmsize)
+        core->currentScript->snapshot.save(memory, ptr);
+
+    return true;
+}
+
+static void keepAmplitudes(struct sound_register_data* dst, const struct sound_register_data* src)
+{
+    for(s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+        dst->data[i].amp = src->data[i].amp;
+
+    dst->pcm.amp = src->pcm.amp;
+}
+
+bool tic_core_state_load(tic_mem* memory, const void* buffer, s32 size)
+{
+    tic_core* core = (tic_core*)memory;
+    const u8* ptr = buffer;
+
+    StateHeader header;
+    if(size < (s32)sizeof header)
+        return false;
+
+    memcpy(&header, ptr, sizeof header);
+    ptr += sizeof header;
+
+    if(header.magic != TIC_STATE_MAGIC || header.version != TIC_STATE_VERSION)
+        return false;
+
+    // the state only goes back to the VM it was saved from
+    if(header.initialized != core->state.initialized
+        || header.lang != vmStateLang(core)
+        || header.ramsize != core->ramsize
+        || header.vmsize != vmStateSize(core)
+        || size != tic_core_state_size(memory))
+        return false;
+
+    if(header.vmsize && !core->currentScript->snapshot.load(memory, ptr + sizeof(tic_core_state_data) + header.ramsize))
+        return false;
+
+    tic_core_state_data* state = &core->state;
+    tic_tick tick = state->tick;
+    tic_blit_callback callback = state->callback;
+
+    // blip buffers can't be saved, so they stay as they are
+    // and the registers keep the amplitudes fed to them
+    struct sound_register_data left = state->registers.left;
+    struct sound_register_data right = state->registers.right;
+
+    memcpy(state, ptr, sizeof(tic_core_state_data));
+    ptr += sizeof(tic_core_state_data);
+    memcpy(memory->ram, ptr, header.ramsize);
+
+    state->tick = tick;
+    state->callback = callback;
+    keepAmplitudes(&state->registers.left, &left);
+    keepAmplitudes(&state->registers.right, &right);
+
+    ptrdiff_t shift = (u8*)memory->ram - (u8*)(uintptr_t)header.ram;
+    for(s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+    {
+        tic_command_data* command = &state->music.commands[i];
+        if(command->delay.row)
+            command->delay.row = (const tic_track_row*)((const u8*)command->delay.row + shift);
+    }
+
+    updateSfxPos(core);
+    memory->input.data = header.input;
+
+    return true;
+}
+
+// instances loaded from the same data share one refcounted cart block,
+// the first one to write to it gets a private copy
+typedef struct CartBlock
+{
+    tic_cartridge cart; // it should be first
+    s32 refs;
+    s32 size;
+    u64 hash;
+    void* data; // what the cart was loaded from, only kept while shared
+    bool shared;
+    struct CartBlock* next;
+} CartBlock;
+
+static CartBlock* SharedCarts;
+
+// the list and the refs are guarded by the lock the host gives, if any
+static struct
+{
+    void* data;
+    void (*lock)(void*);
+    void (*unlock)(void*);
+} CartsLock;
+
+void tic_core_cart_lock(void* data, void (*lock)(void*), void (*unlock)(void*))
+{
+    CartsLock.data = data;
+    CartsLock.lock = lock;
+    CartsLock.unlock = unlock;
+}
+
+static void lockCarts()
+{
+    if(CartsLock.lock)
+        CartsLock.lock(CartsLock.data);
+}
+
+static void unlockCarts()
+{
+    if(CartsLock.unlock)
+        CartsLock.unlock(CartsLock.data);
+}
+
+static CartBlock* cartBlock(tic_mem* memory)
+{
+    return (CartBlock*)memory->cart;
+}
+
+static CartBlock* newCartBlock()
+{
+    CartBlock* block = calloc(1, sizeof(CartBlock));
+    block->refs = 1;
+    return block;
+}
+
+static void unshareCartBlock(CartBlock* block)
+{
+    for(CartBlock** it = &SharedCarts; *it; it = &(*it)->next)
+        if(*it == block)
+        {
+            *it = block->next;
+            break;
+        }
+
+    FREE(block->data);
+    block->data = NULL;
+    block->shared = false;
+}
+
+static void freeCartBlock(CartBlock* block)
+{
+    FREE(block->data);
+    free(block);
+}
+
+// call it locked
+static void releaseCartBlock(CartBlock* block)
+{
+    if(--block->refs == 0)
+    {
+        if(block->shared)
+            unshareCartBlock(block);
+
+        freeCartBlock(block);
+    }
+}
+
+// call it locked
+static CartBlock* findCartBlock(const void* data, s32 size, u64 hash)
+{
+    for(CartBlock* block = SharedCarts; block; block = block->next)
+        if(block->hash == hash && block->size == size && memcmp(block->data, data, size) == 0)
+            return block;
+
+    return NULL;
+}
+
+void tic_core_cart_share(tic_mem* memory, const void* data, s32 size)
+{
+    u64 hash = tic_tool_hash(data, size, 0);
+
+    lockCarts();
+    CartBlock* block = findCartBlock(data, size, hash);
+    if(block) block->refs++;
+    unlockCarts();
+
+    if(!block)
+    {
+        // parse outside of the lock, another instance can share the same data meanwhile
+        CartBlock* loaded = newCartBlock();
+        tic_cart_load(&loaded->cart, data, size);
+
+        loaded->hash = hash;
+        loaded->size = size;
+        loaded->data = malloc(size);
+        memcpy(loaded->data, data, size);
+
+        lockCarts();
+        block = findCartBlock(data, size, hash);
+        if(block)
+        {
+            block->refs++;
+        }
+        else
+        {
+            block = loaded;
+            block->shared = true;
+            block->next = SharedCarts;
+            SharedCarts = block;
+        }
+        unlockCarts();
+
+        if(block != loaded)
+            freeCartBlock(loaded);
+    }
+
+    lockCarts();
+    releaseCartBlock(cartBlock(memory));
+    unlockCarts();
+
+    memory->cart = &block->cart;
+}
+
+tic_cartridge* tic_core_cart_own(tic_mem* memory)
+{
+    CartBlock* block = cartBlock(memory);
+
+    lockCarts();
+
+    if(block->refs > 1)
+    {
+        CartBlock* copy = newCartBlock();
+        memcpy(&copy->cart, &block->cart, sizeof(tic_cartridge));
+        releaseCartBlock(block);
+        memory->cart = &copy->cart;
+    }
+    // the last owner keeps the block, but nobody else should get the changes
+    else if(block->shared)
+        unshareCartBlock(block);
+
+    unlockCarts();
+
+    return memory->cart;
+}
+
 void tic_core_close(tic_mem* memory)
 {
     tic_core* core = (tic_core*)memory;
@@ -541,6 +1239,12 @@ void tic_core_close(tic_mem* memory)
     free(memory->product.screen);
 #endif
     free(memory->product.samples.buffer);
+    free(ramBlock(memory));
+
+    lockCarts();
+    releaseCartBlock(cartBlock(memory));
+    unlockCarts();
+
     free(core);
 }
 
@@ -614,10 +1318,8 @@ static inline void updpal(tic_mem* tic, tic_blitpal* pal0, tic_blitpal* pal1)
     *pal1 = tic_tool_palette_blit(&vbank1(core)->palette, core->screen_format);
 }
 
-static inline void updbdr(tic_mem* tic, s32 row, u32* ptr, tic_blit_callback clb, tic_blitpal* pal0, tic_blitpal* pal1)
+static inline void updbdr(tic_mem* tic, s32 row, tic_blit_callback clb, tic_blitpal* pal0, tic_blitpal* pal1)
 {
-    tic_core* core = (tic_core*)tic;
-
     if(clb.border) clb.border(tic, row, clb.data);
 
     if(clb.scanline)
@@ -629,8 +1331,6 @@ static inline void updbdr(tic_mem* tic, s32 row, u32* ptr, tic_blit_callback clb
 
     if(clb.border || clb.scanline)
         updpal(tic, pal0, pal1);
-
-    memset4(ptr, pal0->data[vbank0(core)->vars.border], TIC80_FULLWIDTH);
 }
 
 static inline u32 blitpix(tic_mem* tic, s32 offset0, s32 offset1, const tic_blitpal* pal0, const tic_blitpal* pal1)
@@ -643,24 +1343,82 @@ static inline u32 blitpix(tic_mem* tic, s32 offset0, s32 offset1, const tic_blit
         : pal0->data[tic_tool_peek4(vbank0(core)->screen.data, offset0)];
 }
 
-void tic_core_blit_ex(tic_mem* tic, tic_blit_callback clb)
+static inline bool sameVbanks(tic_core* core)
+{
+    return memcmp(vbank0(core), &core->blitted.vbank[0], sizeof(tic_vram)) == 0
+        && memcmp(vbank1(core), &core->blitted.vbank[1], sizeof(tic_vram)) == 0;
+}
+
+// what a row is drawn with besides the screen, the callbacks can change it on any row
+static inline bool sameRegisters(tic_core* core)
+{
+    const tic_vram* blitted = core->blitted.vbank;
+
+    return memcmp(&vbank0(core)->palette, &blitted[0].palette, sizeof(tic_palette)) == 0
+        && memcmp(&vbank1(core)->palette, &blitted[1].palette, sizeof(tic_palette)) == 0
+        && memcmp(&vbank0(core)->vars, &blitted[0].vars, sizeof blitted[0].vars) == 0
+        && memcmp(&vbank1(core)->vars, &blitted[1].vars, sizeof blitted[1].vars) == 0;
+}
+
+typedef enum
+{
+    BlitAll,
+    // the rows are only drawn if the frame differs from the last one,
+    // which is still on the screen if nothing changed it while it was drawn
+    BlitCached,
+    // the cart still sees every BDR/SCN call, only the pixels are skipped
+    BlitNone,
+} BlitMode;
+
+static bool blit(tic_mem* tic, tic_blit_callback clb, BlitMode mode)
 {
     tic_core* core = (tic_core*)tic;
 
     tic_blitpal pal0, pal1;
     updpal(tic, &pal0, &pal1);
 
+    bool cached = mode == BlitCached;
+    bool skip = mode == BlitNone;
+    bool changed = false;
+
+    if(cached)
+    {
+        // the core can't see the writes of a VM that works on the RAM directly
+        skip = core->blitted.valid && sameVbanks(core)
+            && !(core->currentScript && core->currentScript->directRam);
+        core->blitted.dirty = false;
+
+        if(!skip)
+        {
+            memcpy(&core->blitted.vbank[0], vbank0(core), sizeof(tic_vram));
+            memcpy(&core->blitted.vbank[1], vbank1(core), sizeof(tic_vram));
+        }
+    }
+
     s32 row = 0;
     u32* rowPtr = tic->product.screen;
 
-#define UPDBDR() updbdr(tic, row, rowPtr, clb, &pal0, &pal1)
+#define UPDBDR()                                                                    \
+    updbdr(tic, row, clb, &pal0, &pal1);                                            \
+    if(cached && !changed && (core->blitted.dirty || !sameRegisters(core)))         \
+        changed = true, skip = false;                                               \
+    if(!skip) memset4(rowPtr, pal0.data[vbank0(core)->vars.border], TIC80_FULLWIDTH)
 
     for(; row != TIC80_MARGIN_TOP; ++row, rowPtr += TIC80_FULLWIDTH)
+    {
         UPDBDR();
+    }
 
     for(; row != TIC80_FULLHEIGHT - TIC80_MARGIN_BOTTOM; ++row)
     {
         UPDBDR();
+
+        if(skip)
+        {
+            rowPtr += TIC80_FULLWIDTH;
+            continue;
+        }
+
         rowPtr += TIC80_MARGIN_LEFT;
 
         if(*(u16*)&vbank0(core)->vars.offset == 0 && *(u16*)&vbank1(core)->vars.offset == 0)
@@ -687,9 +1445,26 @@ void tic_core_blit_ex(tic_mem* tic, tic_blit_callback clb)
     }
 
     for(; row != TIC80_FULLHEIGHT; ++row, rowPtr += TIC80_FULLWIDTH)
+    {
         UPDBDR();
+    }
 
 #undef  UPDBDR
+
+    // a frame the callbacks changed can't be told apart from the next one
+    if(cached)
+        core->blitted.valid = !changed && sameVbanks(core);
+
+    return !skip;
+}
+
+void tic_core_blit_ex(tic_mem* tic, tic_blit_callback clb)
+{
+    tic_core* core = (tic_core*)tic;
+
+    // the screen is drawn over, the next cached blit can't trust it
+    core->blitted.valid = false;
+    blit(tic, clb, BlitAll);
 }
 
 static inline void scanline(tic_mem* memory, s32 row, void* data)
@@ -697,7 +1472,7 @@ static inline void scanline(tic_mem* memory, s32 row, void* data)
     tic_core* core = (tic_core*)memory;
 
     if (core->state.initialized)
-        core->state.callback.scanline(memory, row, data);
+        VM_PROTECT(core, core->state.callback.scanline(memory, row, data));
 }
 
 static inline void border(tic_mem* memory, s32 row, void* data)
@@ -705,7 +1480,7 @@ static inline void border(tic_mem* memory, s32 row, void* data)
     tic_core* core = (tic_core*)memory;
 
     if (core->state.initialized)
-        core->state.callback.border(memory, row, data);
+        VM_PROTECT(core, core->state.callback.border(memory, row, data));
 }
 
 void tic_core_blit(tic_mem* tic)
@@ -713,6 +1488,17 @@ void tic_core_blit(tic_mem* tic)
     tic_core_blit_ex(tic, (tic_blit_callback){scanline, border, NULL});
 }
 
+bool tic_core_blit_cached(tic_mem* tic)
+{
+    return blit(tic, (tic_blit_callback){scanline, border, NULL}, BlitCached);
+}
+
+// the screen isn't touched, so a cached blit can still trust it
+void tic_core_blit_skip(tic_mem* tic)
+{
+    blit(tic, (tic_blit_callback){scanline, border, NULL}, BlitNone);
+}
+
 tic_mem* tic_core_create(s32 samplerate, tic80_pixel_color_format format)
 {
     tic_core* core = (tic_core*)malloc(sizeof(tic_core));
@@ -721,9 +1507,16 @@ tic_mem* tic_core_create(s32 samplerate, tic80_pixel_color_format format)
     tic80* product = &core->memory.product;
 
     core->screen_format = format;
-    core->memory.ram = (tic_ram*)malloc(TIC_RAM_SIZE);
-    core->memory.base_ram = core->memory.ram;
+    // the RAM is a single block with a header in front, so the VM
+    // can use it as its own memory (see tic_core_ram_resize)
+    core->memory.ram = (tic_ram*)((u8*)malloc(TIC_RAM_HEADER_SIZE + TIC_RAM_SIZE) + TIC_RAM_HEADER_SIZE);
+    core->memory.cart = &newCartBlock()->cart;
+    core->ramsize = TIC_RAM_SIZE;
     core->samplerate = samplerate;
+    core->ramresize = tic_core_ram_resize;
+    core->arena.limit = TIC_VM_MEMORY_LIMIT;
+    core->arena.realloc = vmRealloc;
+    core->arena.release = vmRelease;
 
     memset(core->memory.ram, 0, sizeof(tic_ram));
 #ifdef __3DS__
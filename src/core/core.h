@@ -26,6 +26,9 @@
 #include "tools.h"
 #include "script.h"
 
+#include <stddef.h>
+#include <setjmp.h>
+
 #define CLOCKRATE (255<<13)
 #define TIC_DEFAULT_COLOR 15
 #define TIC_SOUND_RINGBUF_LEN 12 // in worst case, this induces ~ 12 tick delay i.e. 200 ms
@@ -153,6 +156,7 @@ typedef struct
     tic_blit_callback callback;
 
     u32 synced;
+    u32 frame; // ticks since the reset, for the frames clock
 
     struct
     {
@@ -168,6 +172,19 @@ typedef struct
     bool initialized;
 } tic_core_state_data;
 
+// the VM arena hands small blocks out of big chunks and keeps the freed ones
+// by size, a big block gets a chunk of its own, so dropping the VM frees
+// a few chunks whatever the number of allocations
+#define TIC_VM_CHUNK_SIZE (64*1024)
+#define TIC_VM_SMALL_SIZE 1024
+#define TIC_VM_ALIGN 8
+
+typedef struct tic_vm_chunk
+{
+    struct tic_vm_chunk* prev;
+    struct tic_vm_chunk* next;
+} tic_vm_chunk;
+
 typedef struct
 {
     tic_mem memory; // it should be first
@@ -183,9 +200,56 @@ typedef struct
     } blip;
 
     s32 samplerate;
+    s32 ramsize;
+    bool (*ramresize)(tic_mem* memory, s32 size); // for plugin runtimes
+
+    // every allocation of the script VM goes here,
+    // so the VM can be capped and dropped in one go
+    struct
+    {
+        tic_vm_chunk* chunks;   // the chunks and the big blocks
+        void* free[TIC_VM_SMALL_SIZE / TIC_VM_ALIGN];
+        u8* top;
+        u8* end;
+
+        size_t used;
+        size_t peak;
+        size_t limit;
+
+        // runtimes can be loaded as plugins, so they go through these;
+        // like lua_Alloc, ptr is NULL or a block of osize bytes and nsize 0 frees it
+        void* (*realloc)(tic_mem* memory, void* ptr, size_t osize, size_t nsize);
+        void (*release)(tic_mem* memory);
+    } arena;
+
+    // set while the core is calling into the script, a runtime that
+    // can't recover from an error outside of its protected calls
+    // (e.g. out of arena memory) jumps here and the VM is dropped
+    jmp_buf* panic;
+
+    // random seed given to the runtimes, see tic_core_seed
+    struct
+    {
+        u32 value;
+        bool set;
+    } seed;
+
+    // the cost of the last collector step in counter ticks,
+    // so tic_core_gc doesn't start a step it has no time for
+    u64 gcstep;
+
     tic_tick_data* data;
     tic_core_state_data state;
 
+    // the video banks the screen was last drawn from, see tic_core_blit_cached
+    struct
+    {
+        tic_vram vbank[2];
+        bool valid;
+        // the VRAM was written since the blit began, set by the API writes
+        bool dirty;
+    } blitted;
+
     struct
     {
         tic_core_state_data state;
@@ -212,7 +276,27 @@ typedef struct
 
 } tic_core;
 
+// for runtimes that don't pass the old size, it's kept in front of the block
+static inline void* tic_vm_realloc(tic_core* core, void* ptr, size_t size)
+{
+    u64* block = ptr ? (u64*)ptr - 1 : NULL;
+    u64* next = core->arena.realloc(&core->memory, block,
+        block ? sizeof(u64) + *block : 0, size ? sizeof(u64) + size : 0);
+
+    if(!next || !size)
+        return NULL;
+
+    *next = size;
+    return next + 1;
+}
+
+static inline size_t tic_vm_block_size(const void* ptr)
+{
+    return ptr ? ((const u64*)ptr)[-1] : 0;
+}
+
 void tic_core_tick_io(tic_mem* memory);
+bool tic_core_ram_resize(tic_mem* memory, s32 size);
 void tic_core_sound_tick_start(tic_mem* memory);
 void tic_core_sound_tick_end(tic_mem* memory);
 
@@ -395,6 +395,7 @@ void tic_api_cls(tic_mem* tic, u8 color)
     {
         memset(&vram->screen, (color & 0xf) | (color << TIC_PALETTE_BPP), sizeof(tic_screen));
         ZEROMEM(ZBuffer);
+        core->blitted.dirty = true;
     }
     else
     {
@@ -209,12 +209,67 @@ static_assert(sizeof(Header) == RGBA_SIZE, "header_size");
 #define HEADER_BITS 4
 #define HEADER_SIZE (sizeof(Header) * BITS_IN_BYTE / HEADER_BITS)
 
-static inline void bitcpy(u8* dst, u32 to, const u8* src, u32 from, u32 size)
+// gather the low `bits` of `count` bytes into a packed bit stream
+static void packBits(u8* dst, const u8* src, s32 count, s32 bits)
 {
-    for(s32 i = 0; i < size; i++, to++, from++)
-        BITCHECK(src[from >> 3], from & 7) 
-            ? _BITSET(dst[to >> 3], to & 7) 
-            : _BITCLEAR(dst[to >> 3], to & 7);
+    const u32 mask = (1u << bits) - 1;
+    u64 acc = 0;
+    s32 size = 0;
+
+    for(const u8* end = src + count; src < end; src++)
+    {
+        acc |= (u64)(*src & mask) << size;
+
+        if((size += bits) >= 32)
+        {
+            *dst++ = acc;
+            *dst++ = acc >> 8;
+            *dst++ = acc >> 16;
+            *dst++ = acc >> 24;
+            acc >>= 32;
+            size -= 32;
+        }
+    }
+
+    for(; size > 0; size -= BITS_IN_BYTE, acc >>= BITS_IN_BYTE)
+        *dst++ = acc;
+}
+
+// spread a packed bit stream of `size` bytes over the low `bits` of `count` bytes,
+// the bits past the stream are random
+static void unpackBits(u8* dst, s32 count, const u8* src, s32 size, s32 bits)
+{
+    const u32 mask = (1u << bits) - 1;
+    const u8* end = src + size;
+    u64 acc = 0;
+    s32 avail = 0;
+
+    for(s32 i = 0; i < count; i++)
+    {
+        if(avail < bits)
+        {
+            if(end - src >= 4)
+            {
+                acc |= (u64)(src[0] | src[1] << 8 | src[2] << 16 | (u32)src[3] << 24) << avail;
+                src += 4;
+                avail += 32;
+            }
+            else if(src < end)
+            {
+                acc |= (u64)*src++ << avail;
+                avail += BITS_IN_BYTE;
+            }
+            else
+            {
+                acc |= (u64)(rand() & mask) << avail;
+                avail += bits;
+            }
+        }
+
+        dst[i] = (dst[i] & ~mask) | (acc & mask);
+        acc >>= bits;
+        avail -= bits;
+    }
 }
 
 static inline s32 ceildiv(s32 a, s32 b)
@@ -233,16 +288,8 @@ png_buffer png_encode(png_buffer cover, png_buffer cart)
     // only save with steganography if there are enough pixels for the size of the cartidge
     if (coverSize >= cartBits) 
     {
-        for (s32 i = 0; i < HEADER_SIZE; i++)
-            bitcpy(png.data, i << 3, header.data, i * HEADER_BITS, HEADER_BITS);
-
-        u8* dst = png.data + HEADER_SIZE;
-        s32 end = ceildiv(cartBits, header.bits);
-        for (s32 i = 0; i < end; i++)
-            bitcpy(dst, i << 3, cart.data, i * header.bits, header.bits);
-
-        for (s32 i = end; i < coverSize; i++)
-            bitcpy(dst, i << 3, (const u8[]){rand()}, 0, header.bits);
+        unpackBits(png.data, HEADER_SIZE, header.data, sizeof(Header), HEADER_BITS);
+        unpackBits(png.data + HEADER_SIZE, coverSize, cart.data, cart.size, header.bits);
     }
 
     png_buffer out = png_write(png, cart);
@@ -252,43 +299,81 @@ png_buffer png_encode(png_buffer cover, png_buffer cart)
     return out;
 }
 
-png_buffer png_decode(png_buffer cover)
+static inline u32 readBE32(const u8* ptr)
+{
+    return (u32)ptr[0] << 24 | ptr[1] << 16 | ptr[2] << 8 | ptr[3];
+}
+
+png_buffer png_cart(png_buffer png)
 {
-    png_buffer cart = { 0 };
-    png_img png = png_read(cover, &cart);
+    enum {SignatureSize = 8, LengthSize = 4, TypeSize = 4, CrcSize = 4};
 
+    if (png.size < SignatureSize || png_sig_cmp(png.data, 0, SignatureSize) != 0)
+        return (png_buffer) { 0 };
+
+    // walk the chunks without decoding anything
+    for (const u8 *ptr = png.data + SignatureSize, *end = png.data + png.size;
+        end - ptr >= LengthSize + TypeSize + CrcSize;)
+    {
+        u32 size = readBE32(ptr);
+        const u8* type = ptr + LengthSize;
+        const u8* data = type + TypeSize;
+
+        if (size > end - data - CrcSize)
+            break;
+
+        if (!memcmp(type, EXTRA_CHUNK, TypeSize))
+            return (png_buffer) { (u8*)data, size };
+
+        if (!memcmp(type, "IEND", TypeSize))
+            break;
+
+        ptr = data + size + CrcSize;
+    }
+
+    return (png_buffer) { 0 };
+}
+
+png_buffer png_decode(png_buffer cover)
+{
     // if we have a data from a png chunk, use that
-    if (cart.data && cart.size > 0)
+    png_buffer chunk = png_cart(cover);
+
+    if (chunk.size > 0)
     {
-        if (png.data)
-            free(png.data);
-        return cart;
+        png_buffer cart = png_create(chunk.size);
+
+        if (cart.data)
+            memcpy(cart.data, chunk.data, chunk.size);
+
+        return cart.data ? cart : (png_buffer) { 0 };
     }
 
     // otherwise fallback to steganography
+    png_img png = png_read(cover, NULL);
+
     if (png.data)
     {
         Header header;
-
-        for (s32 i = 0; i < HEADER_SIZE; i++)
-            bitcpy(header.data, i * HEADER_BITS, png.data, i << 3, HEADER_BITS);
+        packBits(header.data, png.data, HEADER_SIZE, HEADER_BITS);
 
         if (header.bits > 0 
             && header.bits <= BITS_IN_BYTE 
             && header.size > 0 
             && header.size <= png.width * png.height * RGBA_SIZE * header.bits / BITS_IN_BYTE - HEADER_SIZE)
         {
-            s32 aligned = header.size + ceildiv(header.size * BITS_IN_BYTE % header.bits, BITS_IN_BYTE);
-            png_buffer out = { malloc(aligned), header.size };
+            // packBits writes whole bytes up to the last partial one
+            s32 count = ceildiv(header.size * BITS_IN_BYTE, header.bits);
+            png_buffer out = { malloc(ceildiv(count * header.bits, BITS_IN_BYTE)), header.size };
 
-            const u8* from = png.data + HEADER_SIZE;
-            for (s32 i = 0, end = ceildiv(header.size * BITS_IN_BYTE, header.bits); i < end; i++)
-                bitcpy(out.data, i * header.bits, from, i << 3, header.bits);
+            packBits(out.data, png.data + HEADER_SIZE, count, header.bits);
 
             free(png.data);
 
             return out;
         }
+
+        free(png.data);
     }
 
     return (png_buffer) { 0 };
@@ -65,3 +65,6 @@ png_buffer png_write(png_img src, png_buffer cart);
 
 png_buffer png_encode(png_buffer cover, png_buffer cart);
 png_buffer png_decode(png_buffer cover);
+
+// cart chunk data inside the png buffer (not a copy), or empty
+png_buffer png_cart(png_buffer png);
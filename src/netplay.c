@@ -0,0 +1,427 @@
+// MIT License
+
+// Copyright (c) 2020 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "netplay.h"
+#include "tools.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NETPLAY_MAGIC 0x4e
+#define NETPLAY_FRAMES 64           // inputs kept, way more than the peers can drift apart
+#define NETPLAY_NONE 0xffffffff
+
+// magic, player, players, count, seed, cart, ack, start, then count inputs from start
+enum {HeaderSize = 20};
+
+typedef struct
+{
+    void* data;
+    s32 size;
+    s32 capacity;
+} State;
+
+struct tic_netplay
+{
+    tic_netplay_transport transport;
+
+    s32 players;
+    s32 local;
+    s32 delay;
+    u32 seed;
+    u32 cart;
+    u32 heard;
+    u32 refused;    // peers running another cart
+
+    u32 frame;      // the next frame to play
+    u32 rollback;   // the first frame played with a wrong guess
+    bool lockstep;  // the runtime can't save its state, nothing is guessed
+
+    u32 received[TIC_NETPLAY_PLAYERS];  // inputs known for every player, the local one too
+    u32 acked[TIC_NETPLAY_PLAYERS];     // local inputs every peer has
+
+    u8 inputs[NETPLAY_FRAMES][TIC_NETPLAY_PLAYERS];
+    u8 played[NETPLAY_FRAMES][TIC_NETPLAY_PLAYERS];
+
+    // the machine before each frame that can still be played again
+    State states[TIC_NETPLAY_WINDOW + 1];
+};
+
+static void put32(u8* ptr, u32 value)
+{
+    for(s32 i = 0; i < 4; i++)
+        ptr[i] = (u8)(value >> (i * 8));
+}
+
+static u32 get32(const u8* ptr)
+{
+    return ptr[0] | ptr[1] << 8 | ptr[2] << 16 | (u32)ptr[3] << 24;
+}
+
+static u32 confirmed(tic_netplay* netplay)
+{
+    u32 frame = NETPLAY_NONE;
+
+    for(s32 p = 0; p < netplay->players; p++)
+        frame = MIN(frame, netplay->received[p]);
+
+    return frame;
+}
+
+static void receive(tic_netplay* netplay)
+{
+    u8 packet[TIC_NETPLAY_PACKET];
+    s32 size, peer;
+
+    while((size = netplay->transport.recv(netplay->transport.data, &peer, packet, sizeof packet)) > 0)
+    {
+        if(peer < 0 || peer >= netplay->players || peer == netplay->local
+            || size < HeaderSize || size < HeaderSize + packet[3]
+            || packet[0] != NETPLAY_MAGIC || packet[1] != peer || packet[2] != netplay->players)
+            continue;
+
+        if(get32(packet + 8) != netplay->cart)
+        {
+            netplay->refused |= 1 << peer;
+            continue;
+        }
+
+        netplay->heard |= 1 << peer;
+
+        if(peer == 0)
+            netplay->seed = get32(packet + 4);
+
+        u32 ack = get32(packet + 12);
+        if(ack > netplay->acked[peer] && ack <= netplay->received[netplay->local])
+            netplay->acked[peer] = ack;
+
+        u32 start = get32(packet + 16);
+        const u8* inputs = packet + HeaderSize;
+
+        for(u32 frame = start, end = start + packet[3]; frame < end; frame++)
+        {
+            // the inputs come in order, the ring can't take more than that
+            if(frame != netplay->received[peer]
+                || frame >= netplay->frame + NETPLAY_FRAMES - TIC_NETPLAY_WINDOW - 1)
+                continue;
+
+            u8 input = inputs[frame - start];
+            netplay->inputs[frame % NETPLAY_FRAMES][peer] = input;
+            netplay->received[peer]++;
+
+            if(frame < netplay->frame && netplay->played[frame % NETPLAY_FRAMES][peer] != input)
+                netplay->rollback = MIN(netplay->rollback, frame);
+        }
+    }
+}
+
+// every packet carries all the local inputs the peer hasn't confirmed,
+// so a lost one is made up by the next
+static void send(tic_netplay* netplay)
+{
+    const s32 local = netplay->local;
+
+    for(s32 p = 0; p < netplay->players; p++)
+    {
+        if(p == local)
+            continue;
+
+        u8 packet[TIC_NETPLAY_PACKET];
+        u32 start = netplay->acked[p];
+        s32 count = MIN(netplay->received[local] - start, TIC_NETPLAY_PACKET - HeaderSize);
+
+        packet[0] = NETPLAY_MAGIC;
+        packet[1] = local;
+        packet[2] = netplay->players;
+        packet[3] = count;
+        put32(packet + 4, netplay->seed);
+        put32(packet + 8, netplay->cart);
+        put32(packet + 12, netplay->received[p]);
+        put32(packet + 16, start);
+
+        for(s32 i = 0; i < count; i++)
+            packet[HeaderSize + i] = netplay->inputs[(start + i) % NETPLAY_FRAMES][local];
+
+        netplay->transport.send(netplay->transport.data, p, packet, HeaderSize + count);
+    }
+}
+
+// a missing input is guessed to be the last known one
+static tic80_gamepads gamepads(tic_netplay* netplay, u32 frame)
+{
+    tic80_gamepads gamepads = {0};
+    tic80_gamepad* pads[] = {&gamepads.first, &gamepads.second, &gamepads.third, &gamepads.fourth};
+    u8* played = netplay->played[frame % NETPLAY_FRAMES];
+
+    for(s32 p = 0; p < netplay->players; p++)
+    {
+        u32 received = netplay->received[p];
+
+        played[p] = frame < received
+            ? netplay->inputs[frame % NETPLAY_FRAMES][p]
+            : received ? netplay->inputs[(received - 1) % NETPLAY_FRAMES][p] : 0;
+
+        pads[p]->data = played[p];
+    }
+
+    return gamepads;
+}
+
+static void saveState(tic_netplay* netplay, tic_mem* memory, u32 frame)
+{
+    State* state = &netplay->states[frame % COUNT_OF(netplay->states)];
+    s32 size = tic_core_state_size(memory);
+
+    state->size = 0;
+
+    if(size > state->capacity)
+    {
+        void* data = realloc(state->data, size);
+
+        if(!data)
+            return;
+
+        state->data = data;
+        state->capacity = size;
+    }
+
+    if(size && tic_core_state_save(memory, state->data, size))
+        state->size = size;
+}
+
+static bool loadState(tic_netplay* netplay, tic_mem* memory, u32 frame)
+{
+    State* state = &netplay->states[frame % COUNT_OF(netplay->states)];
+
+    return state->size && tic_core_state_load(memory, state->data, state->size);
+}
+
+tic_netplay* tic_netplay_create(s32 players, s32 local, s32 delay, u32 cart, tic_netplay_transport transport)
+{
+    if(players < 2 || players > TIC_NETPLAY_PLAYERS || local < 0 || local >= players)
+        return NULL;
+
+    tic_netplay* netplay = calloc(1, sizeof(tic_netplay));
+
+    if(netplay)
+    {
+        netplay->transport = transport;
+        netplay->players = players;
+        netplay->local = local;
+        netplay->delay = CLAMP(delay, 0, TIC_NETPLAY_MAX_DELAY);
+        netplay->seed = local == 0 ? (u32)time(NULL) : 0;
+        netplay->cart = cart;
+        netplay->rollback = NETPLAY_NONE;
+
+        // nobody presses anything during the delay
+        for(s32 p = 0; p < players; p++)
+            netplay->received[p] = netplay->acked[p] = netplay->delay;
+    }
+
+    return netplay;
+}
+
+void tic_netplay_close(tic_netplay* netplay)
+{
+    if(netplay->transport.close)
+        netplay->transport.close(netplay->transport.data);
+
+    for(s32 i = 0; i < COUNT_OF(netplay->states); i++)
+        free(netplay->states[i].data);
+
+    free(netplay);
+}
+
+bool tic_netplay_ready(tic_netplay* netplay)
+{
+    u32 peers = ((1 << netplay->players) - 1) & ~(1 << netplay->local);
+    return (netplay->heard & peers) == peers;
+}
+
+bool tic_netplay_refused(tic_netplay* netplay)
+{
+    return netplay->refused != 0;
+}
+
+u32 tic_netplay_seed(tic_netplay* netplay)
+{
+    return netplay->seed;
+}
+
+u32 tic_netplay_frame(tic_netplay* netplay)
+{
+    return netplay->frame;
+}
+
+bool tic_netplay_input(tic_netplay* netplay, tic80_gamepad gamepad)
+{
+    receive(netplay);
+
+    bool ready = tic_netplay_ready(netplay);
+    u32* local = &netplay->received[netplay->local];
+
+    // a waiting game keeps the input it was given first
+    if(ready && *local == netplay->frame + netplay->delay)
+    {
+        netplay->inputs[*local % NETPLAY_FRAMES][netplay->local] = gamepad.data;
+        (*local)++;
+    }
+
+    send(netplay);
+
+    // the first frame starts the VM, it can't be played again
+    u32 ahead = netplay->lockstep || netplay->frame == 0 ? 0 : TIC_NETPLAY_WINDOW;
+
+    return ready && netplay->frame < confirmed(netplay) + ahead;
+}
+
+s32 tic_netplay_advance(tic_netplay* netplay, tic_mem* memory, tic_netplay_tick tick, void* data)
+{
+    s32 replayed = 0;
+
+    if(netplay->rollback < netplay->frame && loadState(netplay, memory, netplay->rollback))
+    {
+        for(u32 frame = netplay->rollback; frame < netplay->frame; frame++, replayed++)
+        {
+            if(frame > netplay->rollback)
+                saveState(netplay, memory, frame);
+
+            tick(data, gamepads(netplay, frame), true);
+        }
+    }
+
+    netplay->rollback = NETPLAY_NONE;
+
+    if(!netplay->lockstep)
+        saveState(netplay, memory, netplay->frame);
+
+    tick(data, gamepads(netplay, netplay->frame), false);
+    netplay->frame++;
+    netplay->lockstep = tic_core_state_size(memory) == 0;
+
+    return replayed;
+}
+
+#define LOOPBACK_QUEUE 256
+
+typedef struct
+{
+    s32 from;
+    s32 size;
+    u8 data[TIC_NETPLAY_PACKET];
+} LoopbackPacket;
+
+typedef struct
+{
+    LoopbackPacket packets[LOOPBACK_QUEUE];
+    u32 head;
+    u32 tail;
+} LoopbackQueue;
+
+typedef struct
+{
+    tic_netplay_loopback* loopback;
+    s32 player;
+} LoopbackEndpoint;
+
+struct tic_netplay_loopback
+{
+    s32 players;
+    s32 refs;
+    LoopbackQueue queues[TIC_NETPLAY_PLAYERS];
+    LoopbackEndpoint endpoints[TIC_NETPLAY_PLAYERS];
+};
+
+// a full queue drops the packet as the network would
+static void loopbackSend(void* data, s32 peer, const void* buffer, s32 size)
+{
+    LoopbackEndpoint* endpoint = data;
+
+    if(peer < 0 || peer >= endpoint->loopback->players || size > TIC_NETPLAY_PACKET)
+        return;
+
+    LoopbackQueue* queue = &endpoint->loopback->queues[peer];
+
+    if(queue->tail - queue->head < LOOPBACK_QUEUE)
+    {
+        LoopbackPacket* packet = &queue->packets[queue->tail++ % LOOPBACK_QUEUE];
+        packet->from = endpoint->player;
+        packet->size = size;
+        memcpy(packet->data, buffer, size);
+    }
+}
+
+static s32 loopbackRecv(void* data, s32* peer, void* buffer, s32 size)
+{
+    LoopbackEndpoint* endpoint = data;
+    LoopbackQueue* queue = &endpoint->loopback->queues[endpoint->player];
+
+    if(queue->head == queue->tail)
+        return 0;
+
+    const LoopbackPacket* packet = &queue->packets[queue->head++ % LOOPBACK_QUEUE];
+    *peer = packet->from;
+    memcpy(buffer, packet->data, MIN(size, packet->size));
+
+    return MIN(size, packet->size);
+}
+
+static void loopbackClose(void* data)
+{
+    LoopbackEndpoint* endpoint = data;
+    tic_netplay_loopback* loopback = endpoint->loopback;
+
+    if(--loopback->refs == 0)
+        free(loopback);
+}
+
+tic_netplay_loopback* tic_netplay_loopback_create(s32 players)
+{
+    if(players < 2 || players > TIC_NETPLAY_PLAYERS)
+        return NULL;
+
+    tic_netplay_loopback* loopback = calloc(1, sizeof(tic_netplay_loopback));
+
+    if(loopback)
+    {
+        loopback->players = players;
+        loopback->refs = players;
+
+        for(s32 i = 0; i < players; i++)
+            loopback->endpoints[i] = (LoopbackEndpoint){loopback, i};
+    }
+
+    return loopback;
+}
+
+tic_netplay_transport tic_netplay_loopback_transport(tic_netplay_loopback* loopback, s32 player)
+{
+    return (tic_netplay_transport)
+    {
+        .data = &loopback->endpoints[player],
+        .send = loopbackSend,
+        .recv = loopbackRecv,
+        .close = loopbackClose,
+    };
+}
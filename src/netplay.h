@@ -0,0 +1,83 @@
+// MIT License
+
+// Copyright (c) 2020 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "api.h"
+
+// rollback netplay for up to 4 players, one gamepad each:
+// every peer runs the whole game, frames are played with the inputs known so far
+// and played again from a saved state when a late input differs from the guess,
+// carts whose runtime can't save its state wait for all the inputs instead
+
+#define TIC_NETPLAY_PLAYERS 4
+#define TIC_NETPLAY_WINDOW 8        // frames played ahead of the confirmed inputs
+#define TIC_NETPLAY_MAX_DELAY 8
+#define TIC_NETPLAY_PACKET 64
+
+// peers are numbered as the players, the packets can be lost or reordered
+typedef struct
+{
+    void* data;
+    void (*send)(void* data, s32 peer, const void* buffer, s32 size);
+    // the size of the next packet, 0 if there is none
+    s32 (*recv)(void* data, s32* peer, void* buffer, s32 size);
+    void (*close)(void* data);
+} tic_netplay_transport;
+
+// plays one frame with the gamepads of all the players,
+// the hidden ones are played again later and aren't shown
+typedef void(*tic_netplay_tick)(void* data, tic80_gamepads gamepads, bool hidden);
+
+typedef struct tic_netplay tic_netplay;
+
+// delay is the frames before the local input is played, it saves rollbacks on slow links,
+// cart is a hash of the loaded cart, the peers running another one are refused
+tic_netplay* tic_netplay_create(s32 players, s32 local, s32 delay, u32 cart, tic_netplay_transport transport);
+void tic_netplay_close(tic_netplay* netplay);
+
+// takes the local gamepad for the next frame, false if the game has to wait for the peers
+bool tic_netplay_input(tic_netplay* netplay, tic80_gamepad gamepad);
+// plays the frames to catch up with the late inputs and the next one, returns the number of frames played again
+s32 tic_netplay_advance(tic_netplay* netplay, tic_mem* memory, tic_netplay_tick tick, void* data);
+
+// all the peers have answered
+bool tic_netplay_ready(tic_netplay* netplay);
+// a peer runs another cart, the session won't start
+bool tic_netplay_refused(tic_netplay* netplay);
+// the session start time of the first player, the same for every peer,
+// the random seed and the base of tstamp()
+u32 tic_netplay_seed(tic_netplay* netplay);
+u32 tic_netplay_frame(tic_netplay* netplay);
+
+// in-process transports for the tests and local play, the same for every player
+typedef struct tic_netplay_loopback tic_netplay_loopback;
+
+tic_netplay_loopback* tic_netplay_loopback_create(s32 players);
+// closing all the transports frees the loopback
+tic_netplay_transport tic_netplay_loopback_transport(tic_netplay_loopback* loopback, s32 player);
+
+#if defined(TIC80_NETPLAY_UDP)
+// peers are "host:port" for every player, the local one is only used for its port
+bool tic_netplay_udp(tic_netplay_transport* transport, const char* const* peers, s32 players, s32 local);
+#endif
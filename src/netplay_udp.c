@@ -0,0 +1,197 @@
+// MIT License
+
+// Copyright (c) 2020 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "netplay.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#   include <winsock2.h>
+#   include <ws2tcpip.h>
+typedef SOCKET Socket;
+#else
+#   include <sys/types.h>
+#   include <sys/socket.h>
+#   include <netinet/in.h>
+#   include <netdb.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+typedef int Socket;
+#   define INVALID_SOCKET (-1)
+#   define closesocket close
+#endif
+
+typedef struct
+{
+    Socket socket;
+    s32 players;
+    struct sockaddr_in peers[TIC_NETPLAY_PLAYERS];
+} Udp;
+
+// "host:port", IPv4 only
+static bool resolve(const char* peer, struct sockaddr_in* addr)
+{
+    const char* colon = strrchr(peer, ':');
+
+    if(!colon || colon - peer >= 256)
+        return false;
+
+    char host[256];
+    memcpy(host, peer, colon - peer);
+    host[colon - peer] = '\0';
+
+    struct addrinfo hints = {.ai_family = AF_INET, .ai_socktype = SOCK_DGRAM};
+    struct addrinfo* info = NULL;
+
+    if(getaddrinfo(*host ? host : NULL, colon + 1, &hints, &info) || !info)
+        return false;
+
+    memcpy(addr, info->ai_addr, sizeof *addr);
+    freeaddrinfo(info);
+
+    return true;
+}
+
+static void udpSend(void* data, s32 peer, const void* buffer, s32 size)
+{
+    Udp* udp = data;
+
+    sendto(udp->socket, buffer, size, 0, (const struct sockaddr*)&udp->peers[peer], sizeof udp->peers[peer]);
+}
+
+static s32 udpRecv(void* data, s32* peer, void* buffer, s32 size)
+{
+    Udp* udp = data;
+
+    for(;;)
+    {
+        struct sockaddr_in from;
+        socklen_t length = sizeof from;
+        s32 received = (s32)recvfrom(udp->socket, buffer, size, 0, (struct sockaddr*)&from, &length);
+
+        if(received < 0)
+            return 0;
+
+        // packets from anybody else are dropped
+        for(s32 p = 0; p < udp->players; p++)
+        {
+            const struct sockaddr_in* addr = &udp->peers[p];
+
+            if(addr->sin_addr.s_addr == from.sin_addr.s_addr && addr->sin_port == from.sin_port)
+            {
+                *peer = p;
+                return received;
+            }
+        }
+    }
+}
+
+static void udpClose(void* data)
+{
+    Udp* udp = data;
+
+    closesocket(udp->socket);
+    free(udp);
+
+#if defined(_WIN32)
+    WSACleanup();
+#endif
+}
+
+// bound to the local player port, the game never waits for the network
+static Socket openSocket(const struct sockaddr_in* local)
+{
+    Socket sock = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if(sock != INVALID_SOCKET)
+    {
+        struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = local->sin_port};
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+        if(bind(sock, (const struct sockaddr*)&addr, sizeof addr))
+        {
+            closesocket(sock);
+            return INVALID_SOCKET;
+        }
+
+#if defined(_WIN32)
+        u_long mode = 1;
+        ioctlsocket(sock, FIONBIO, &mode);
+#else
+        fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+#endif
+    }
+
+    return sock;
+}
+
+bool tic_netplay_udp(tic_netplay_transport* transport, const char* const* peers, s32 players, s32 local)
+{
+    if(players < 2 || players > TIC_NETPLAY_PLAYERS || local < 0 || local >= players)
+        return false;
+
+#if defined(_WIN32)
+    WSADATA wsa;
+    if(WSAStartup(MAKEWORD(2, 2), &wsa))
+        return false;
+#endif
+
+    Udp* udp = calloc(1, sizeof(Udp));
+    bool done = udp != NULL;
+
+    if(done)
+    {
+        udp->players = players;
+
+        for(s32 p = 0; p < players && done; p++)
+            done = resolve(peers[p], &udp->peers[p]);
+
+        if(done)
+        {
+            udp->socket = openSocket(&udp->peers[local]);
+            done = udp->socket != INVALID_SOCKET;
+        }
+    }
+
+    if(done)
+    {
+        *transport = (tic_netplay_transport)
+        {
+            .data = udp,
+            .send = udpSend,
+            .recv = udpRecv,
+            .close = udpClose,
+        };
+    }
+    else
+    {
+        free(udp);
+
+#if defined(_WIN32)
+        WSACleanup();
+#endif
+    }
+
+    return done;
+}
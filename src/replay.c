@@ -0,0 +1,309 @@
+// MIT License
+
+// Copyright (c) 2020 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "replay.h"
+#include "cart.h"
+#include "tools.h"
+#include "core/core.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_MAGIC "TICR"
+#define REPLAY_VERSION 1
+
+static_assert(sizeof(tic80_gamepads) == 4, "tic80_gamepads");
+static_assert(sizeof(tic80_mouse) == 4, "tic80_mouse");
+static_assert(sizeof(tic80_keyboard) == 4, "tic80_keyboard");
+
+// frames only keep what changed since the previous one
+enum
+{
+    ReplayGamepads  = 1 << 0,
+    ReplayMouse     = 1 << 1,
+    ReplayKeyboard  = 1 << 2,
+};
+
+struct tic_replay
+{
+    tic_replay_header header;
+
+    tic_replay_frame* frames;
+    s32 count;
+    s32 capacity;
+};
+
+typedef struct
+{
+    u8* data;
+    s32 size;
+    s32 capacity;
+} Writer;
+
+typedef struct
+{
+    const u8* ptr;
+    const u8* end;
+} Reader;
+
+static void writeBytes(Writer* writer, const void* data, s32 size)
+{
+    if(writer->size + size > writer->capacity)
+    {
+        writer->capacity = MAX(writer->capacity * 2, writer->size + size);
+        writer->data = realloc(writer->data, writer->capacity);
+    }
+
+    memcpy(writer->data + writer->size, data, size);
+    writer->size += size;
+}
+
+static void writeU32(Writer* writer, u32 value)
+{
+    u8 bytes[] = {value, value >> 8, value >> 16, value >> 24};
+    writeBytes(writer, bytes, sizeof bytes);
+}
+
+static void writeVarint(Writer* writer, s32 value)
+{
+    // zigzag, small negative values stay short
+    u32 bits = ((u32)value << 1) ^ (u32)(value >> 31);
+
+    for(; bits >= 0x80; bits >>= 7)
+        writeBytes(writer, &(u8){(bits & 0x7f) | 0x80}, 1);
+
+    writeBytes(writer, &(u8){bits}, 1);
+}
+
+static bool readBytes(Reader* reader, void* data, s32 size)
+{
+    if(reader->end - reader->ptr < size)
+        return false;
+
+    memcpy(data, reader->ptr, size);
+    reader->ptr += size;
+
+    return true;
+}
+
+static bool readU32(Reader* reader, u32* value)
+{
+    u8 bytes[4];
+
+    if(!readBytes(reader, bytes, sizeof bytes))
+        return false;
+
+    *value = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (u32)bytes[3] << 24;
+    return true;
+}
+
+static bool readVarint(Reader* reader, s32* value)
+{
+    u32 bits = 0;
+
+    for(s32 shift = 0; shift < 35; shift += 7)
+    {
+        u8 byte;
+
+        if(!readBytes(reader, &byte, 1))
+            return false;
+
+        bits |= (u32)(byte & 0x7f) << shift;
+
+        if(!(byte & 0x80))
+        {
+            *value = (s32)(bits >> 1) ^ -(s32)(bits & 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+tic_replay* tic_replay_create(const tic_replay_header* header)
+{
+    tic_replay* replay = calloc(1, sizeof(tic_replay));
+    replay->header = *header;
+
+    return replay;
+}
+
+void tic_replay_close(tic_replay* replay)
+{
+    free(replay->frames);
+    free(replay);
+}
+
+void tic_replay_add(tic_replay* replay, const tic_replay_frame* frame)
+{
+    if(replay->count == replay->capacity)
+    {
+        replay->capacity = MAX(replay->capacity * 2, 1024);
+        replay->frames = realloc(replay->frames, replay->capacity * sizeof(tic_replay_frame));
+    }
+
+    replay->frames[replay->count++] = *frame;
+}
+
+void* tic_replay_save(tic_replay* replay, s32* size)
+{
+    Writer writer = {0};
+    const tic_replay_header* header = &replay->header;
+
+    writeBytes(&writer, REPLAY_MAGIC, STRLEN(REPLAY_MAGIC));
+    writeBytes(&writer, &(u8){REPLAY_VERSION}, 1);
+    writeU32(&writer, header->seed);
+    writeU32(&writer, (u32)header->cart);
+    writeU32(&writer, (u32)(header->cart >> 32));
+    writeBytes(&writer, &header->mapping, sizeof header->mapping);
+    writeBytes(&writer, &header->persistent, sizeof header->persistent);
+    writeU32(&writer, replay->count);
+
+    // the clock goes as the difference between the frame times,
+    // which is the same most of the time
+    tic_replay_frame prev = {0};
+    s32 step = 0;
+
+    for(s32 i = 0; i < replay->count; i++)
+    {
+        const tic_replay_frame* frame = &replay->frames[i];
+        const tic80_input* input = &frame->input;
+
+        u8 flags = 0;
+        if(input->gamepads.data != prev.input.gamepads.data) flags |= ReplayGamepads;
+        if(memcmp(&input->mouse, &prev.input.mouse, sizeof input->mouse)) flags |= ReplayMouse;
+        if(input->keyboard.data != prev.input.keyboard.data) flags |= ReplayKeyboard;
+
+        writeBytes(&writer, &flags, 1);
+
+        if(flags & ReplayGamepads) writeBytes(&writer, &input->gamepads, sizeof input->gamepads);
+        if(flags & ReplayMouse) writeBytes(&writer, &input->mouse, sizeof input->mouse);
+        if(flags & ReplayKeyboard) writeBytes(&writer, &input->keyboard, sizeof input->keyboard);
+
+        s32 delta = (s32)(frame->time - prev.time);
+        writeVarint(&writer, delta - step);
+        writeVarint(&writer, frame->tstamp - prev.tstamp);
+        writeU32(&writer, frame->hash);
+
+        step = delta;
+        prev = *frame;
+    }
+
+    *size = writer.size;
+    return writer.data;
+}
+
+tic_replay* tic_replay_load(const void* buffer, s32 size)
+{
+    Reader reader = {buffer, (const u8*)buffer + size};
+    tic_replay_header header;
+
+    char magic[STRLEN(REPLAY_MAGIC)];
+    u8 version;
+    u32 lo, hi, count;
+
+    if(!readBytes(&reader, magic, sizeof magic) || memcmp(magic, REPLAY_MAGIC, sizeof magic)
+        || !readBytes(&reader, &version, 1) || version != REPLAY_VERSION
+        || !readU32(&reader, &header.seed)
+        || !readU32(&reader, &lo) || !readU32(&reader, &hi)
+        || !readBytes(&reader, &header.mapping, sizeof header.mapping)
+        || !readBytes(&reader, &header.persistent, sizeof header.persistent)
+        || !readU32(&reader, &count))
+        return NULL;
+
+    header.cart = (u64)hi << 32 | lo;
+
+    tic_replay* replay = tic_replay_create(&header);
+    tic_replay_frame frame = {0};
+    s32 step = 0;
+
+    for(u32 i = 0; i < count; i++)
+    {
+        u8 flags;
+        s32 delta, tstamp;
+
+        if(!readBytes(&reader, &flags, 1)
+            || ((flags & ReplayGamepads) && !readBytes(&reader, &frame.input.gamepads, sizeof frame.input.gamepads))
+            || ((flags & ReplayMouse) && !readBytes(&reader, &frame.input.mouse, sizeof frame.input.mouse))
+            || ((flags & ReplayKeyboard) && !readBytes(&reader, &frame.input.keyboard, sizeof frame.input.keyboard))
+            || !readVarint(&reader, &delta)
+            || !readVarint(&reader, &tstamp)
+            || !readU32(&reader, &frame.hash))
+        {
+            tic_replay_close(replay);
+            return NULL;
+        }
+
+        step += delta;
+        frame.time += step;
+        frame.tstamp += tstamp;
+
+        tic_replay_add(replay, &frame);
+    }
+
+    return replay;
+}
+
+const tic_replay_header* tic_replay_info(tic_replay* replay)
+{
+    return &replay->header;
+}
+
+s32 tic_replay_count(tic_replay* replay)
+{
+    return replay->count;
+}
+
+const tic_replay_frame* tic_replay_get(tic_replay* replay, s32 index)
+{
+    return index >= 0 && index < replay->count ? &replay->frames[index] : NULL;
+}
+
+// the saved cart, so the stale bytes the editors leave after the code
+// and in the unused parts of the sections don't count
+u64 tic_replay_cart(const tic_cartridge* cart)
+{
+    u8* buffer = malloc(sizeof(tic_cartridge));
+    u64 hash = 0;
+
+    if(buffer)
+    {
+        hash = tic_tool_hash(buffer, tic_cart_save(cart, buffer), 0);
+        free(buffer);
+    }
+
+    return hash;
+}
+
+// the whole RAM, WASM carts can grow it past the TIC RAM
+u32 tic_replay_hash(tic_mem* memory)
+{
+    return (u32)tic_tool_hash(memory->ram, ((tic_core*)memory)->ramsize, 0);
+}
+
+void tic_replay_clock(tic_tick_data* data, const tic_replay_frame* frame)
+{
+    data->clock.mode = TIC80_CLOCK_HOST;
+    data->clock.time = frame->time / 1000.0;
+    data->clock.tstamp = frame->tstamp;
+}
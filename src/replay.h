@@ -0,0 +1,63 @@
+// MIT License
+
+// Copyright (c) 2020 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "api.h"
+
+#define TIC_REPLAY_EXT ".ticreplay"
+
+// one tick of a recorded session
+typedef struct
+{
+    tic80_input input;
+    u64 time;       // cart clock in microseconds
+    s32 tstamp;
+    u32 hash;       // RAM after the tick
+} tic_replay_frame;
+
+// what the session started with
+typedef struct
+{
+    u32 seed;
+    u64 cart;
+    tic_mapping mapping;
+    tic_persistent persistent;
+} tic_replay_header;
+
+typedef struct tic_replay tic_replay;
+
+tic_replay* tic_replay_create(const tic_replay_header* header);
+tic_replay* tic_replay_load(const void* buffer, s32 size);
+void tic_replay_close(tic_replay* replay);
+void tic_replay_add(tic_replay* replay, const tic_replay_frame* frame);
+// file data, has to be freed
+void* tic_replay_save(tic_replay* replay, s32* size);
+
+const tic_replay_header* tic_replay_info(tic_replay* replay);
+s32 tic_replay_count(tic_replay* replay);
+const tic_replay_frame* tic_replay_get(tic_replay* replay, s32 index);
+
+u64 tic_replay_cart(const tic_cartridge* cart);
+u32 tic_replay_hash(tic_mem* memory);
+// fix the cart clock to the frame values
+void tic_replay_clock(tic_tick_data* data, const tic_replay_frame* frame);
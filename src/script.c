@@ -175,8 +175,8 @@ const tic_script* tic_get_script(tic_mem* memory)
 {
     FOREACH_LANG(script)
     {
-        if(script->id == memory->cart.lang
-            || strcmp(tic_tool_metatag(memory->cart.code.data, "script", script->singleComment), script->name) == 0)
+        if(script->id == memory->cart->lang
+            || strcmp(tic_tool_metatag(memory->cart->code.data, "script", script->singleComment), script->name) == 0)
             return script;
     }
 
@@ -59,6 +59,8 @@ struct tic_script
     tic_lang_isalnum lang_isalnum;
     bool useStructuredEdition;
     bool useBinarySection;
+    // the VM writes the RAM directly, not only through the API
+    bool directRam;
 
     s32 api_keywordsCount;
     const char** api_keywords;
@@ -70,6 +72,43 @@ struct tic_script
         const char* name;
     } demo, mark, *demos;
 
+    // optional, lets the core cache compiled code between runs
+    struct
+    {
+        // runtime version, invalidates the cache on upgrade
+        const char* version;
+        // compile code without running it, returns malloc'ed bytecode or NULL on error
+        void*(*compile)(tic_mem* memory, const char* code, s32* size);
+        // same as init, but from the bytecode made by compile
+        bool(*load)(tic_mem* memory, const void* buffer, s32 size);
+    } bytecode;
+
+    // optional, lets the host run the garbage collector between frames
+    struct
+    {
+        // do a bit of collection work, returns true when a cycle is finished
+        bool(*step)(tic_mem* memory);
+        // heap size in bytes
+        s32(*heap)(tic_mem* memory);
+    } gc;
+
+    // optional, lets the core save the VM to a machine state,
+    // the TIC RAM block is saved by the core and isn't counted here
+    struct
+    {
+        // snapshot size in bytes
+        s32(*size)(tic_mem* memory);
+        void(*save)(tic_mem* memory, void* buffer);
+        bool(*load)(tic_mem* memory, const void* buffer);
+        // the most the RAM block and the snapshot can take together for
+        // the loaded cart, the machine state is reported at this size
+        s32(*bound)(tic_mem* memory);
+    } snapshot;
+
+    // optional, reseeds the random generator of a running VM,
+    // a new VM takes the seed from the core at init (see tic_core_seed)
+    void(*seed)(tic_mem* memory, u32 seed);
+
 };
 
 typedef struct tic_script tic_script;
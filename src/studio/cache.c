@@ -0,0 +1,302 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "studio.h"
+#include "cache.h"
+#include "tools.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define CACHE_INDEX "index.txt"
+#define CACHE_NAME_MAX 64
+
+typedef struct
+{
+    char name[CACHE_NAME_MAX];
+    s32 size;
+    u64 hash;
+    u32 stamp; // last access
+} CacheEntry;
+
+struct tic_cache
+{
+    tic_fs* fs;
+    char dir[TICNAME_MAX];
+
+    s32 budget;
+    s64 total;
+    u32 stamp;
+    bool dirty;
+
+    CacheEntry* entries;
+    s32 count;
+};
+
+static const char* cachePath(tic_cache* cache, const char* name)
+{
+    static char path[TICNAME_MAX];
+    snprintf(path, sizeof path, "%s%s", cache->dir, name);
+    return path;
+}
+
+static bool validName(const char* name)
+{
+    if(!*name || strlen(name) >= CACHE_NAME_MAX || strcmp(name, CACHE_INDEX) == 0)
+        return false;
+
+    for(const char* ptr = name; *ptr; ptr++)
+        if(isspace(*ptr) || *ptr == '/' || *ptr == '\\')
+            return false;
+
+    return true;
+}
+
+static CacheEntry* findEntry(tic_cache* cache, const char* name)
+{
+    for(CacheEntry *entry = cache->entries, *end = entry + cache->count; entry < end; entry++)
+        if(strcmp(entry->name, name) == 0)
+            return entry;
+
+    return NULL;
+}
+
+static CacheEntry* addEntry(tic_cache* cache, const char* name, s32 size, u64 hash, u32 stamp)
+{
+    CacheEntry* entries = realloc(cache->entries, sizeof(CacheEntry) * (cache->count + 1));
+
+    if(!entries)
+        return NULL;
+
+    cache->entries = entries;
+
+    CacheEntry* entry = &entries[cache->count++];
+    strcpy(entry->name, name);
+    entry->size = size;
+    entry->hash = hash;
+    entry->stamp = stamp;
+
+    cache->total += size;
+    cache->stamp = MAX(cache->stamp, stamp);
+    cache->dirty = true;
+
+    return entry;
+}
+
+static void removeEntry(tic_cache* cache, CacheEntry* entry)
+{
+    char path[TICNAME_MAX];
+    snprintf(path, sizeof path, "/%s", cachePath(cache, entry->name));
+    tic_fs_delfile(cache->fs, path);
+
+    cache->total -= entry->size;
+    *entry = cache->entries[--cache->count];
+    cache->dirty = true;
+}
+
+static void saveIndex(tic_cache* cache)
+{
+    char* buffer = malloc(cache->count * (CACHE_NAME_MAX + 48) + 1);
+
+    if(buffer)
+    {
+        char* ptr = buffer;
+
+        for(const CacheEntry *entry = cache->entries, *end = entry + cache->count; entry < end; entry++)
+            ptr += sprintf(ptr, "%s %d %08x%08x %u\n", entry->name, entry->size,
+                (u32)(entry->hash >> 32), (u32)entry->hash, entry->stamp);
+
+        tic_fs_saveroot(cache->fs, cachePath(cache, CACHE_INDEX), buffer, (s32)(ptr - buffer), true);
+        free(buffer);
+
+        cache->dirty = false;
+    }
+}
+
+static void loadIndex(tic_cache* cache, const char* text, s32 size)
+{
+    char* index = malloc(size + 1);
+
+    if(!index)
+        return;
+
+    memcpy(index, text, size);
+    index[size] = '\0';
+
+    for(char* line = strtok(index, "\n"); line; line = strtok(NULL, "\n"))
+    {
+        char name[CACHE_NAME_MAX];
+        s32 fileSize;
+        u32 hi, lo, stamp;
+
+        if(sscanf(line, "%63s %d %8x%8x %u", name, &fileSize, &hi, &lo, &stamp) == 5
+            && validName(name) && !findEntry(cache, name))
+        {
+            addEntry(cache, name, fileSize, (u64)hi << 32 | lo, stamp);
+        }
+    }
+
+    free(index);
+    cache->dirty = false;
+}
+
+static void adoptFile(tic_cache* cache, const char* name)
+{
+    s32 size = 0;
+    void* data = tic_fs_loadroot(cache->fs, cachePath(cache, name), &size);
+
+    if(data)
+    {
+        addEntry(cache, name, size, tic_tool_hash(data, size, TIC_HASH_SEED), 0);
+        free(data);
+    }
+}
+
+static bool onCacheFile(const char* name, const char* title, const char* hash, s32 id, void* data, bool dir)
+{
+    tic_cache* cache = data;
+
+    if(!dir && validName(name) && !findEntry(cache, name))
+        adoptFile(cache, name);
+
+    return true;
+}
+
+static void evict(tic_cache* cache, s32 size)
+{
+    while(cache->count && cache->total + size > cache->budget)
+    {
+        CacheEntry* oldest = cache->entries;
+
+        for(CacheEntry *entry = cache->entries, *end = entry + cache->count; entry < end; entry++)
+            if(entry->stamp < oldest->stamp)
+                oldest = entry;
+
+        removeEntry(cache, oldest);
+    }
+}
+
+tic_cache* tic_cache_create(tic_fs* fs, const char* dir, s32 budget)
+{
+    tic_cache* cache = calloc(1, sizeof(tic_cache));
+
+    if(cache)
+    {
+        cache->fs = fs;
+        cache->budget = budget;
+        strncpy(cache->dir, dir, sizeof cache->dir - 1);
+
+        s32 size = 0;
+        void* index = tic_fs_loadroot(fs, cachePath(cache, CACHE_INDEX), &size);
+
+        if(index)
+        {
+            loadIndex(cache, index, size);
+            free(index);
+        }
+        else
+        {
+            // files cached before the index existed
+            fs_enum(tic_fs_pathroot(fs, dir), onCacheFile, cache);
+        }
+
+        evict(cache, 0);
+
+        if(cache->dirty)
+            saveIndex(cache);
+    }
+
+    return cache;
+}
+
+void tic_cache_close(tic_cache* cache)
+{
+    if(cache->dirty)
+        saveIndex(cache);
+
+    FREE(cache->entries);
+    free(cache);
+}
+
+void tic_cache_budget(tic_cache* cache, s32 budget)
+{
+    cache->budget = budget;
+    evict(cache, 0);
+}
+
+bool tic_cache_has(tic_cache* cache, const char* name)
+{
+    return findEntry(cache, name) != NULL;
+}
+
+void* tic_cache_load(tic_cache* cache, const char* name, s32* size)
+{
+    CacheEntry* entry = findEntry(cache, name);
+
+    if(!entry)
+        return NULL;
+
+    void* data = tic_fs_loadroot(cache->fs, cachePath(cache, name), size);
+
+    // drop the entry if the file is gone or damaged
+    if(!data || *size != entry->size || tic_tool_hash(data, *size, TIC_HASH_SEED) != entry->hash)
+    {
+        FREE(data);
+        removeEntry(cache, entry);
+        return NULL;
+    }
+
+    entry->stamp = ++cache->stamp;
+    cache->dirty = true;
+
+    return data;
+}
+
+void tic_cache_save(tic_cache* cache, const char* name, const void* data, s32 size)
+{
+    if(!validName(name) || size > cache->budget)
+        return;
+
+    u64 hash = tic_tool_hash(data, size, TIC_HASH_SEED);
+    CacheEntry* entry = findEntry(cache, name);
+
+    if(entry)
+    {
+        if(entry->size == size && entry->hash == hash)
+        {
+            entry->stamp = ++cache->stamp;
+            cache->dirty = true;
+            return;
+        }
+
+        removeEntry(cache, entry);
+    }
+
+    evict(cache, size);
+
+    if(tic_fs_saveroot(cache->fs, cachePath(cache, name), data, size, true))
+        addEntry(cache, name, size, hash, ++cache->stamp);
+
+    saveIndex(cache);
+}
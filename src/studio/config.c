@@ -92,6 +92,8 @@ static void setDefault(Config* config)
 #endif
             .volume         = MAX_VOLUME,
             .vsync          = DEFAULT_VSYNC,
+            .frameskip      = 0,
+            .fps            = false,
             .fullscreen     = false,
             .integerScale   = INTEGER_SCALE_DEFAULT,
             .autosave       = false,
@@ -142,7 +144,7 @@ static void reset(Config* config)
 
 static void saveConfigCart(Config* config)
 {
-    *config->cart = config->tic->cart;
+    *config->cart = *config->tic->cart;
     readConfig(config);
     saveConfig(config, true);
 
@@ -175,6 +177,8 @@ static void loadOptions(Config* config)
 #endif
             options->fullscreen = json_bool("fullscreen", 0);
             options->vsync = json_bool("vsync", 0);
+            options->frameskip = CLAMP(json_int("frameskip", 0), 0, TIC_FRAMESKIP_MAX);
+            options->fps = json_bool("fps", 0);
             options->integerScale = json_bool("integerScale", 0);
             options->volume = json_int("volume", 0);
             options->autosave = json_bool("autosave", 0);
@@ -216,6 +220,8 @@ static void saveOptions(Config* config)
 #endif
             "\"fullscreen\":%s, "
             "\"vsync\":%s, "
+            "\"frameskip\":%i, "
+            "\"fps\":%s, "
             "\"integerScale\":%s, "
             "\"volume\":%i, "
             "\"autosave\":%s, "
@@ -233,6 +239,8 @@ static void saveOptions(Config* config)
 #endif
         bool2str(options->fullscreen),
         bool2str(options->vsync),
+        options->frameskip,
+        bool2str(options->fps),
         bool2str(options->integerScale),
         options->volume,
         bool2str(options->autosave),
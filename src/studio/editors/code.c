@@ -3875,7 +3875,7 @@ void initCode(Code* code, Studio* studio)
 
     if(code->history) history_delete(code->history);
 
-    tic_code* src = &getMemory(studio)->cart.code;
+    tic_code* src = &getMemory(studio)->cart->code;
 
     *code = (Code)
     {
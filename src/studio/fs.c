@@ -22,6 +22,7 @@
 
 #include "studio.h"
 #include "fs.h"
+#include "cache.h"
 #include "net.h"
 #include "ext/json.h"
 
@@ -64,11 +65,20 @@
 
 static const char* PublicDir = TIC_HOST;
 
+#define FS_PREFETCH_MAX 8
+
 struct tic_fs
 {
     char dir[TICNAME_MAX];
     char work[TICNAME_MAX];
     tic_net* net;
+
+    tic_cache* cache;
+    s32 cacheSize;
+    char mirror[TICNAME_MAX];
+
+    // hashes being prefetched, to not request them twice
+    char pending[FS_PREFETCH_MAX][TICNAME_MAX];
 };
 
 #if defined(__EMSCRIPTEN__)
@@ -756,12 +766,51 @@ bool tic_fs_saveroot(tic_fs* fs, const char* name, const void* data, s32 size, b
     return fs_write(path, data, size);
 }
 
+tic_cache* tic_fs_cache(tic_fs* fs)
+{
+    if(!fs->cache)
+        fs->cache = tic_cache_create(fs, TIC_CACHE, fs->cacheSize);
+
+    return fs->cache;
+}
+
+void tic_fs_cachesize(tic_fs* fs, s32 size)
+{
+    fs->cacheSize = size;
+
+    if(fs->cache)
+        tic_cache_budget(fs->cache, size);
+}
+
+void tic_fs_mirror(tic_fs* fs, const char* dir)
+{
+    strncpy(fs->mirror, dir, sizeof fs->mirror - 1);
+
+    if(*fs->mirror && fs->mirror[strlen(fs->mirror) - 1] != '/')
+        strcat(fs->mirror, "/");
+}
+
+// cached files are named by the hash plus the extension of the original
+static void hashKey(char* key, const char* name, const char* hash)
+{
+    const char* ext = strrchr(name, '.');
+    snprintf(key, TICNAME_MAX, "%s%s", hash, ext ? ext : "");
+}
+
+static void* loadMirror(tic_fs* fs, const char* name, const char* hash, s32* size)
+{
+    char path[TICNAME_MAX];
+    snprintf(path, sizeof path, "%scart/%s/%s", fs->mirror, hash, name);
+
+    return fs_read(path, size);
+}
+
 typedef struct
 {
     tic_fs* fs;
     fs_load_callback done;
     void* data;
-    char* cachePath;
+    char key[TICNAME_MAX];
 } LoadFileByHashData;
 
 static void fileByHashLoaded(const net_get_data* netData)
@@ -770,17 +819,25 @@ static void fileByHashLoaded(const net_get_data* netData)
 
     if (netData->type == net_get_done)
     {
-        tic_fs_saveroot(loadFileByHashData->fs, loadFileByHashData->cachePath, netData->done.data, netData->done.size, false);
-        loadFileByHashData->done(netData->done.data, netData->done.size, loadFileByHashData->data);
+        tic_cache_save(tic_fs_cache(loadFileByHashData->fs), loadFileByHashData->key, netData->done.data, netData->done.size);
+
+        if(loadFileByHashData->done)
+            loadFileByHashData->done(netData->done.data, netData->done.size, loadFileByHashData->data);
     }
 
     switch (netData->type)
     {
     case net_get_done:
     case net_get_error:
+        {
+            tic_fs* fs = loadFileByHashData->fs;
 
-        free(loadFileByHashData->cachePath);
-        free(loadFileByHashData);
+            for(s32 i = 0; i < FS_PREFETCH_MAX; i++)
+                if(strcmp(fs->pending[i], loadFileByHashData->key) == 0)
+                    *fs->pending[i] = '\0';
+
+            free(loadFileByHashData);
+        }
         break;
     default: break;
     }
@@ -793,12 +850,18 @@ void tic_fs_hashload(tic_fs* fs, const char* name, const char* hash, fs_load_cal
     return;
 #else
 
-    char cachePath[TICNAME_MAX];
-    snprintf(cachePath, sizeof cachePath, TIC_CACHE "%s.tic", hash);
+    char key[TICNAME_MAX];
+    hashKey(key, name, hash);
+
+    tic_cache* cache = tic_fs_cache(fs);
 
     {
         s32 size = 0;
-        void* buffer = tic_fs_loadroot(fs, cachePath, &size);
+        void* buffer = tic_cache_load(cache, key, &size);
+
+        if(!buffer && *fs->mirror && (buffer = loadMirror(fs, name, hash, &size)))
+            tic_cache_save(cache, key, buffer, size);
+
         if (buffer)
         {
             callback(buffer, size, data);
@@ -811,13 +874,73 @@ void tic_fs_hashload(tic_fs* fs, const char* name, const char* hash, fs_load_cal
     char path[TICNAME_MAX];
     snprintf(path, sizeof path, "/cart/%s/%s", hash, name);
 
-    LoadFileByHashData loadFileByHashData = { fs, callback, data, strdup(cachePath) };
+    LoadFileByHashData loadFileByHashData = { fs, callback, data };
+    strcpy(loadFileByHashData.key, key);
     tic_net_get(fs->net, path, fileByHashLoaded, MOVE(loadFileByHashData));
 #endif
 
 #endif
 }
 
+bool tic_fs_hashprefetch(tic_fs* fs, const char* name, const char* hash)
+{
+#if !defined(BAREMETALPI)
+
+    char key[TICNAME_MAX];
+    hashKey(key, name, hash);
+
+    tic_cache* cache = tic_fs_cache(fs);
+
+    if(tic_cache_has(cache, key))
+        return true;
+
+    if(*fs->mirror)
+    {
+        s32 size = 0;
+        void* buffer = loadMirror(fs, name, hash, &size);
+
+        if(buffer)
+        {
+            tic_cache_save(cache, key, buffer, size);
+            free(buffer);
+            return true;
+        }
+
+        return false;
+    }
+
+#if defined(BUILD_SURF)
+    char* slot = NULL;
+
+    for(s32 i = 0; i < FS_PREFETCH_MAX; i++)
+    {
+        if(strcmp(fs->pending[i], key) == 0)
+            return true;
+
+        if(!slot && !*fs->pending[i])
+            slot = fs->pending[i];
+    }
+
+    if(slot)
+    {
+        strcpy(slot, key);
+
+        char path[TICNAME_MAX];
+        snprintf(path, sizeof path, "/cart/%s/%s", hash, name);
+
+        LoadFileByHashData loadFileByHashData = { fs };
+        strcpy(loadFileByHashData.key, key);
+        tic_net_get(fs->net, path, fileByHashLoaded, MOVE(loadFileByHashData));
+
+        return true;
+    }
+#endif
+
+#endif
+
+    return false;
+}
+
 void* tic_fs_load(tic_fs* fs, const char* name, s32* size)
 {
 #if defined(BAREMETALPI)
@@ -963,10 +1086,19 @@ tic_fs* tic_fs_create(const char* path, tic_net* net)
         strcat(fs->dir, SEP);
 
     fs->net = net;
+    fs->cacheSize = TIC_CACHE_SIZE;
 
     return fs;
 }
 
+void tic_fs_close(tic_fs* fs)
+{
+    if(fs->cache)
+        tic_cache_close(fs->cache);
+
+    free(fs);
+}
+
 const char* fs_apppath()
 {
     static char apppath[TICNAME_MAX];
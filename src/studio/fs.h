@@ -32,14 +32,17 @@ typedef void(*fs_load_callback)(const u8* buffer, s32 size, void* data);
 
 typedef struct tic_fs tic_fs;
 struct tic_net;
+struct tic_cache;
 
 tic_fs*     tic_fs_create   (const char* path, struct tic_net* net);
+void        tic_fs_close    (tic_fs* fs);
 const char* tic_fs_path     (tic_fs* fs, const char* name);
 const char* tic_fs_pathroot (tic_fs* fs, const char* name);
 
 void    tic_fs_enum         (tic_fs* fs, fs_list_callback onItem, fs_done_callback onDone, void* data);
 void    tic_fs_isdir_async  (tic_fs* fs, const char* name, fs_isdir_callback callback, void* data);
 void    tic_fs_hashload     (tic_fs* fs, const char* name, const char* hash, fs_load_callback callback, void* data);
+bool    tic_fs_hashprefetch (tic_fs* fs, const char* name, const char* hash);
 bool    tic_fs_delfile      (tic_fs* fs, const char* name);
 bool    tic_fs_deldir       (tic_fs* fs, const char* name);
 bool    tic_fs_save         (tic_fs* fs, const char* name, const void* data, s32 size, bool overwrite);
@@ -56,6 +59,10 @@ void    tic_fs_changedir    (tic_fs* fs, const char* dir);
 void    tic_fs_dir          (tic_fs* fs, char* out);
 void    tic_fs_dirback      (tic_fs* fs);
 void    tic_fs_homedir      (tic_fs* fs);
+void    tic_fs_cachesize    (tic_fs* fs, s32 size);
+void    tic_fs_mirror       (tic_fs* fs, const char* dir);
+
+struct tic_cache* tic_fs_cache(tic_fs* fs);
 
 u64     fs_date     (const char* name);
 bool    fs_exists   (const char* name);
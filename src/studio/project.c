@@ -60,13 +60,20 @@ static bool bufferEmpty(const u8* data, s32 size)
     return true;
 }
 
+static inline char* writeStr(char* ptr, const char* str)
+{
+    size_t size = strlen(str);
+    memcpy(ptr, str, size);
+    return ptr + size;
+}
+
 static char* saveTextSection(char* ptr, const char* data)
 {
     if(data[0] == '\0')
         return ptr;
 
-    sprintf(ptr, "%s\n", data);
-    ptr += strlen(ptr);
+    ptr = writeStr(ptr, data);
+    *ptr++ = '\n';
 
     return ptr;
 }
@@ -76,14 +83,17 @@ static char* saveBinaryBuffer(char* ptr, const char* comment, const void* data,
     if(bufferEmpty(data, size))
         return ptr;
 
-    sprintf(ptr, "%s %03i:", comment, row);
-    ptr += strlen(ptr);
+    ptr = writeStr(ptr, comment);
+    *ptr++ = ' ';
+    *ptr++ = '0' + row / 100 % 10;
+    *ptr++ = '0' + row / 10 % 10;
+    *ptr++ = '0' + row % 10;
+    *ptr++ = ':';
 
     tic_tool_buf2str(data, size, ptr, flip);
-    ptr += strlen(ptr);
+    ptr += size * 2;
 
-    sprintf(ptr, "\n");
-    ptr += strlen(ptr);
+    *ptr++ = '\n';
 
     return ptr;
 }
@@ -93,14 +103,18 @@ static char* saveBinarySection(char* ptr, const char* comment, const char* tag,
     if(bufferEmpty(data, size * count))
         return ptr;
 
-    sprintf(ptr, "%s <%s>\n", comment, tag);
-    ptr += strlen(ptr);
+    ptr = writeStr(ptr, comment);
+    ptr = writeStr(ptr, " <");
+    ptr = writeStr(ptr, tag);
+    ptr = writeStr(ptr, ">\n");
 
     for(s32 i = 0; i < count; i++, data = (u8*)data + size)
         ptr = saveBinaryBuffer(ptr, comment, data, size, i, flip);
 
-    sprintf(ptr, "%s </%s>\n\n", comment, tag);
-    ptr += strlen(ptr);
+    ptr = writeStr(ptr, comment);
+    ptr = writeStr(ptr, " </");
+    ptr = writeStr(ptr, tag);
+    ptr = writeStr(ptr, ">\n\n");
 
     return ptr;
 }
@@ -135,93 +149,139 @@ s32 tic_project_save(const char* name, void* data, const tic_cartridge* cart)
     if(cart->lang)
         ptr = saveBinarySection(ptr, comment, LangSection.tag, LangSection.count, &cart->lang, LangSection.size, LangSection.flip);
 
-    return (s32)strlen(stream);
+    *ptr = '\0';
+
+    return (s32)(ptr - stream);
 }
 
-static bool loadTextSection(const char* project, const char* comment, char* dst, s32 size)
+typedef struct
 {
-    bool done = false;
+    char tag[16];
+    const char* start;  // first data line
+    const char* end;    // '\n' before the closing tag
+} SectionRef;
 
-    const char* start = project;
-    const char* end = project + strlen(project);
+typedef struct
+{
+    const char* code;   // end of the code section
+    s32 count;
+    SectionRef sections[COUNT_OF(BinarySections) * TIC_BANKS + 1];
+} SectionIndex;
 
-    {
-        char tagstart[16];
-        sprintf(tagstart, "\n%s <", comment);
+static inline const char* getLineEnd(const char* ptr)
+{
+    while(*ptr && isspace(*ptr) && *ptr++ != '\n');
 
-        const char* ptr = strstr(project, tagstart);
+    return ptr;
+}
 
-        if(ptr && ptr < end)
-            end = ptr;
-    }
+// find all the <TAG>...</TAG> sections in one pass
+static void indexSections(SectionIndex* index, const char* project, const char* comment)
+{
+    char open[16], close[32];
+    sprintf(open, "\n%s <", comment);
+    const s32 openSize = (s32)strlen(open);
 
-    if(end > start)
+    index->count = 0;
+    index->code = strstr(project, open);
+
+    if(!index->code)
     {
-        memcpy(dst, start, MIN(size, end - start));
-        done = true;
+        index->code = project + strlen(project);
+        return;
     }
 
-    return done;
+    for(const char* ptr = index->code; ptr && index->count < COUNT_OF(index->sections);)
+    {
+        const char* tag = ptr + openSize;
+        const char* tagEnd = strchr(tag, '>');
+
+        if(!tagEnd || *tag == '/' || tagEnd - tag >= sizeof index->sections->tag)
+        {
+            ptr = strstr(ptr + 1, open);
+            continue;
+        }
+
+        SectionRef* section = &index->sections[index->count];
+        memcpy(section->tag, tag, tagEnd - tag);
+        section->tag[tagEnd - tag] = '\0';
+
+        section->start = getLineEnd(tagEnd + 1);
+
+        sprintf(close, "\n%s </%s>", comment, section->tag);
+        section->end = strstr(section->start, close);
+
+        if(section->end > section->start)
+        {
+            index->count++;
+            ptr = strstr(section->end + strlen(close), open);
+        }
+        else ptr = strstr(tagEnd, open);
+    }
 }
 
-static inline const char* getLineEnd(const char* ptr)
+static const SectionRef* findSection(const SectionIndex* index, const char* tag)
 {
-    while(*ptr && isspace(*ptr) && *ptr++ != '\n');
+    for(const SectionRef *section = index->sections, *end = section + index->count; section < end; section++)
+        if(strcmp(section->tag, tag) == 0)
+            return section;
 
-    return ptr;
+    return NULL;
 }
 
-static bool loadBinarySection(const char* project, const char* comment, const char* tag, s32 count, void* dst, s32 size, bool flip)
+static bool loadTextSection(const char* project, const SectionIndex* index, char* dst, s32 size)
 {
-    char tagbuf[64];
-    sprintf(tagbuf, "%s <%s>", comment, tag);
-
-    const char* start = strstr(project, tagbuf);
-    bool done = false;
+    const char* start = project;
+    const char* end = index->code;
 
-    if(start)
+    if(end > start)
     {
-        start += strlen(tagbuf);
-        start = getLineEnd(start);
+        memcpy(dst, start, MIN(size, end - start));
+        return true;
+    }
 
-        sprintf(tagbuf, "\n%s </%s>", comment, tag);
-        const char* end = strstr(start, tagbuf);
+    return false;
+}
 
-        if(end > start)
-        {
-            const char* ptr = start;
+static bool loadBinarySection(const SectionIndex* index, const char* comment, const char* tag, s32 count, void* dst, s32 size, bool flip)
+{
+    const SectionRef* section = findSection(index, tag);
 
-            if(size > 0)
-            {
-                while(ptr < end)
-                {
-                    static char lineStr[] = "999";
-                    memcpy(lineStr, ptr + strlen(comment) + 1, sizeof lineStr - 1);
+    if(!section)
+        return false;
 
-                    s32 index = atoi(lineStr);
+    const char* ptr = section->start;
+    const char* end = section->end;
+    const s32 prefix = (s32)strlen(comment) + sizeof(" 999:") - 1;
 
-                    if(index < count)
-                    {
-                        ptr += strlen(comment) + sizeof(" 999:") - 1;
-                        tic_tool_str2buf(ptr, size*2, (u8*)dst + size*index, flip);
-                        ptr += size*2 + 1;
+    if(size > 0)
+    {
+        while(end - ptr >= prefix + size*2)
+        {
+            const char* num = ptr + prefix - 4;
+            s32 index = 0;
 
-                        ptr = getLineEnd(ptr);
-                    }
-                    else break;
-                }
-            }
-            else
+            for(s32 i = 0; i < 3 && isdigit(num[i]); i++)
+                index = index * 10 + num[i] - '0';
+
+            if(index < count)
             {
-                ptr += strlen(comment) + sizeof(" 999:") - 1;
-                tic_tool_str2buf(ptr, (s32)(end - ptr), (u8*)dst, flip);
-            }
+                ptr += prefix;
+                tic_tool_str2buf(ptr, size*2, (u8*)dst + size*index, flip);
+                ptr += size*2 + 1;
 
-            done = true;
+                ptr = getLineEnd(ptr);
+            }
+            else break;
         }
     }
+    else if(end - ptr > prefix)
+    {
+        ptr += prefix;
+        tic_tool_str2buf(ptr, (s32)(end - ptr), (u8*)dst, flip);
+    }
 
-    return done;
+    return true;
 }
 
 bool tic_project_load(const char* name, const char* data, s32 size, tic_cartridge* dst)
@@ -248,7 +308,10 @@ bool tic_project_load(const char* name, const char* data, s32 size, tic_cartridg
             const char* comment = projectComment(name);
             char tag[16];
 
-            if(loadTextSection(project, comment, cart->code.data, sizeof(tic_code)))
+            SectionIndex index;
+            indexSections(&index, project, comment);
+
+            if(loadTextSection(project, &index, cart->code.data, sizeof(tic_code)))
                 done = true;
 
             if(done)
@@ -257,10 +320,10 @@ bool tic_project_load(const char* name, const char* data, s32 size, tic_cartridg
                     for(s32 b = 0; b < TIC_BANKS; b++)
                     {
                         makeTag(section->tag, tag, b);
-                        loadBinarySection(project, comment, tag, section->count, (u8*)&cart->banks[b] + section->offset, section->size, section->flip);
+                        loadBinarySection(&index, comment, tag, section->count, (u8*)&cart->banks[b] + section->offset, section->size, section->flip);
                     }
 
-                loadBinarySection(project, comment, LangSection.tag, LangSection.count, &cart->lang, LangSection.size, LangSection.flip);
+                loadBinarySection(&index, comment, LangSection.tag, LangSection.count, &cart->lang, LangSection.size, LangSection.flip);
             }
 
             if(done)
@@ -0,0 +1,399 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "rewind.h"
+#include "system.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+    s32 offset;
+    s32 delta;  // packed delta to the previous frame
+    s32 key;    // packed frame after the delta, 0 if it isn't a keyframe
+} Record;
+
+struct tic_rewind
+{
+    s32 budget;
+    s32 keyframes;
+    s32 frames; // since the last keyframe
+
+    u8* ring;
+    s32 head;   // end of the newest record
+
+    // records from the oldest to the newest, circular
+    Record* records;
+    s32 first;
+    s32 count;
+    s32 capacity;
+
+    s32 size;
+    bool hasLast;
+    u8* last;   // newest frame
+    u8* next;   // frame being pushed
+    u8* temp;
+    u8* packed;
+
+    struct
+    {
+        void* thread;
+        void* work;
+        void* idle;
+        bool pending;
+        bool quit;
+    } worker;
+};
+
+static u8* writeVarint(u8* ptr, u32 value)
+{
+    for(; value >= 0x80; value >>= 7)
+        *ptr++ = (value & 0x7f) | 0x80;
+
+    *ptr++ = value;
+    return ptr;
+}
+
+static const u8* readVarint(const u8* ptr, u32* value)
+{
+    *value = 0;
+
+    for(s32 shift = 0;; shift += 7)
+    {
+        u8 byte = *ptr++;
+        *value |= (u32)(byte & 0x7f) << shift;
+
+        if(!(byte & 0x80))
+            return ptr;
+    }
+}
+
+// zero runs and literal runs, a lone zero stays in the literals
+static s32 pack(const u8* src, s32 size, u8* dst)
+{
+    u8* ptr = dst;
+
+    for(s32 i = 0; i < size;)
+    {
+        s32 zeros = i;
+        while(i < size && !src[i]) i++;
+        zeros = i - zeros;
+
+        s32 start = i;
+        while(i < size && (src[i] || (i + 1 < size && src[i + 1]))) i++;
+
+        ptr = writeVarint(ptr, zeros);
+        ptr = writeVarint(ptr, i - start);
+        memcpy(ptr, src + start, i - start);
+        ptr += i - start;
+    }
+
+    return (s32)(ptr - dst);
+}
+
+// the unpacked data is XORed into dst
+static void unpack(const u8* src, s32 size, u8* dst)
+{
+    const u8* end = src + size;
+
+    while(src < end)
+    {
+        u32 zeros, literals;
+        src = readVarint(src, &zeros);
+        src = readVarint(src, &literals);
+
+        dst += zeros;
+
+        for(u32 i = 0; i < literals; i++)
+            *dst++ ^= *src++;
+    }
+}
+
+static Record* getRecord(tic_rewind* rewind, s32 index)
+{
+    return &rewind->records[(rewind->first + index) % rewind->capacity];
+}
+
+static void dropOldest(tic_rewind* rewind)
+{
+    rewind->first = (rewind->first + 1) % rewind->capacity;
+    rewind->count--;
+}
+
+static void dropNewest(tic_rewind* rewind)
+{
+    rewind->count--;
+
+    if(rewind->count)
+    {
+        const Record* newest = getRecord(rewind, rewind->count - 1);
+        rewind->head = newest->offset + newest->delta + newest->key;
+    }
+    else rewind->head = 0;
+}
+
+static void dropRecords(tic_rewind* rewind)
+{
+    rewind->first = rewind->count = rewind->head = 0;
+}
+
+static bool addRecord(tic_rewind* rewind, const u8* data, s32 delta, s32 key)
+{
+    s32 size = delta + key;
+
+    if(size > rewind->budget)
+        return false;
+
+    if(!rewind->ring)
+        rewind->ring = malloc(rewind->budget);
+
+    if(rewind->count == rewind->capacity)
+    {
+        s32 capacity = MAX(rewind->capacity * 2, 1024);
+        Record* records = malloc(capacity * sizeof(Record));
+
+        for(s32 i = 0; i < rewind->count; i++)
+            records[i] = *getRecord(rewind, i);
+
+        free(rewind->records);
+        rewind->records = records;
+        rewind->capacity = capacity;
+        rewind->first = 0;
+    }
+
+    s32 pos = rewind->head;
+
+    // the records behind the head are the oldest ones,
+    // they go first when the ring wraps around
+    if(pos + size > rewind->budget)
+    {
+        while(rewind->count && getRecord(rewind, 0)->offset >= pos)
+            dropOldest(rewind);
+
+        pos = 0;
+    }
+
+    while(rewind->count)
+    {
+        const Record* oldest = getRecord(rewind, 0);
+
+        if(oldest->offset < pos + size && pos < oldest->offset + oldest->delta + oldest->key)
+            dropOldest(rewind);
+        else break;
+    }
+
+    memcpy(rewind->ring + pos, data, size);
+    *getRecord(rewind, rewind->count++) = (Record){pos, delta, key};
+    rewind->head = pos + size;
+
+    return true;
+}
+
+static void storeFrame(tic_rewind* rewind)
+{
+    if(rewind->hasLast)
+    {
+        for(s32 i = 0; i < rewind->size; i++)
+            rewind->temp[i] = rewind->last[i] ^ rewind->next[i];
+
+        s32 delta = pack(rewind->temp, rewind->size, rewind->packed);
+        s32 key = 0;
+
+        if(++rewind->frames >= rewind->keyframes)
+        {
+            rewind->frames = 0;
+            key = pack(rewind->next, rewind->size, rewind->packed + delta);
+        }
+
+        // the frame doesn't fit the budget at all, so nothing before it can be reached
+        if(!addRecord(rewind, rewind->packed, delta, key))
+            dropRecords(rewind);
+    }
+
+    u8* last = rewind->last;
+    rewind->last = rewind->next;
+    rewind->next = last;
+    rewind->hasLast = true;
+}
+
+static s32 rewindThread(void* data)
+{
+    tic_rewind* rewind = data;
+
+    for(;;)
+    {
+        tic_sys_sem_wait(rewind->worker.work);
+
+        if(rewind->worker.quit)
+            break;
+
+        storeFrame(rewind);
+        tic_sys_sem_post(rewind->worker.idle);
+    }
+
+    return 0;
+}
+
+// the frames belong to the worker until it's done with the pending one
+static void waitWorker(tic_rewind* rewind)
+{
+    if(rewind->worker.pending)
+    {
+        tic_sys_sem_wait(rewind->worker.idle);
+        rewind->worker.pending = false;
+    }
+}
+
+tic_rewind* tic_rewind_create(s32 budget, s32 keyframes)
+{
+    tic_rewind* rewind = calloc(1, sizeof(tic_rewind));
+
+    rewind->budget = budget;
+    rewind->keyframes = MAX(keyframes, 1);
+
+    rewind->worker.work = tic_sys_sem_create(0);
+    rewind->worker.idle = tic_sys_sem_create(0);
+
+    if(rewind->worker.work && rewind->worker.idle)
+        rewind->worker.thread = tic_sys_thread_create(rewindThread, rewind);
+
+    return rewind;
+}
+
+void tic_rewind_close(tic_rewind* rewind)
+{
+    waitWorker(rewind);
+
+    if(rewind->worker.thread)
+    {
+        rewind->worker.quit = true;
+        tic_sys_sem_post(rewind->worker.work);
+        tic_sys_thread_join(rewind->worker.thread);
+    }
+
+    if(rewind->worker.work) tic_sys_sem_free(rewind->worker.work);
+    if(rewind->worker.idle) tic_sys_sem_free(rewind->worker.idle);
+
+    free(rewind->ring);
+    free(rewind->records);
+    free(rewind->last);
+    free(rewind->next);
+    free(rewind->temp);
+    free(rewind->packed);
+    free(rewind);
+}
+
+void tic_rewind_clear(tic_rewind* rewind)
+{
+    waitWorker(rewind);
+
+    dropRecords(rewind);
+    rewind->hasLast = false;
+    rewind->frames = 0;
+}
+
+void* tic_rewind_begin(tic_rewind* rewind, s32 size)
+{
+    waitWorker(rewind);
+
+    if(size != rewind->size)
+    {
+        tic_rewind_clear(rewind);
+
+        rewind->size = size;
+        rewind->last = realloc(rewind->last, size);
+        rewind->next = realloc(rewind->next, size);
+        rewind->temp = realloc(rewind->temp, size);
+        // worst case of the delta and the keyframe
+        rewind->packed = realloc(rewind->packed, (size + size / 2 + 16) * 2);
+    }
+
+    return rewind->next;
+}
+
+void tic_rewind_end(tic_rewind* rewind)
+{
+    if(rewind->worker.thread)
+    {
+        rewind->worker.pending = true;
+        tic_sys_sem_post(rewind->worker.work);
+    }
+    else storeFrame(rewind);
+}
+
+s32 tic_rewind_count(tic_rewind* rewind)
+{
+    waitWorker(rewind);
+
+    return rewind->hasLast ? rewind->count : 0;
+}
+
+const void* tic_rewind_seek(tic_rewind* rewind, s32 frames)
+{
+    if(frames < 0 || frames > tic_rewind_count(rewind) || !rewind->hasLast)
+        return NULL;
+
+    // frame the newest record leads to is the last one,
+    // so going back is undoing the deltas from the newest record down
+    s32 from = rewind->count - 1;
+    s32 target = from - frames;
+
+    for(s32 i = MAX(target, 0); i < from && i - target < frames; i++)
+    {
+        const Record* record = getRecord(rewind, i);
+
+        if(record->key)
+        {
+            memset(rewind->temp, 0, rewind->size);
+            unpack(rewind->ring + record->offset + record->delta, record->key, rewind->temp);
+            from = i;
+            break;
+        }
+    }
+
+    if(from == rewind->count - 1)
+        memcpy(rewind->temp, rewind->last, rewind->size);
+
+    for(s32 i = from; i > target; i--)
+    {
+        const Record* record = getRecord(rewind, i);
+        unpack(rewind->ring + record->offset, record->delta, rewind->temp);
+    }
+
+    return rewind->temp;
+}
+
+const void* tic_rewind_back(tic_rewind* rewind, s32 frames)
+{
+    if(!tic_rewind_seek(rewind, frames))
+        return NULL;
+
+    for(s32 i = 0; i < frames; i++)
+        dropNewest(rewind);
+
+    u8* last = rewind->last;
+    rewind->last = rewind->temp;
+    rewind->temp = last;
+
+    return rewind->last;
+}
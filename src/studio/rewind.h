@@ -0,0 +1,43 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <tic80_types.h>
+
+// gameplay rewind, every frame is kept as a XOR delta to the previous one
+// packed with RLE in a ring buffer with a size budget, with a full frame
+// every few frames to seek faster
+typedef struct tic_rewind tic_rewind;
+
+tic_rewind* tic_rewind_create   (s32 budget, s32 keyframes);
+void        tic_rewind_close    (tic_rewind* rewind);
+void        tic_rewind_clear    (tic_rewind* rewind);
+// buffer for the next frame, it's packed in the background after tic_rewind_end
+void*       tic_rewind_begin    (tic_rewind* rewind, s32 size);
+void        tic_rewind_end      (tic_rewind* rewind);
+// number of frames to go back
+s32         tic_rewind_count    (tic_rewind* rewind);
+// frame from the given number of frames back, NULL if it isn't kept
+const void* tic_rewind_seek     (tic_rewind* rewind, s32 frames);
+// same, but the newer frames are dropped
+const void* tic_rewind_back     (tic_rewind* rewind, s32 frames);
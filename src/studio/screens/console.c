@@ -749,17 +749,17 @@ static void loadCartSection(Console* console, const tic_cartridge* cart, const c
     if(section)
     {
         if(strcmp(section, "code") == 0)
-            memcpy(&tic->cart.code, &cart->code, sizeof(tic_code));
+            memcpy(&tic->cart->code, &cart->code, sizeof(tic_code));
         else
             FOR(const struct Section*, it, Sections)
                 if(strcmp(section, it->name) == 0)
                 {
-                    memcpy((u8*)&tic->cart.bank0 + it->offset, (const u8*)&cart->bank0 + it->offset, it->size);
+                    memcpy((u8*)&tic->cart->bank0 + it->offset, (const u8*)&cart->bank0 + it->offset, it->size);
                     break;
                 }
     }
     else
-        memcpy(&tic->cart, cart, sizeof(tic_cartridge));
+        memcpy(tic->cart, cart, sizeof(tic_cartridge));
 }
 
 static char* getDemoCartPath(char* path, const tic_script* script)
@@ -821,7 +821,7 @@ static void onLoadDemoCommandConfirmed(Console* console, const tic_script* scrip
     }
 
     data = getDemoCart(console, script, &size);
-    tic_cart_load(&console->tic->cart, data, size);
+    tic_cart_load(console->tic->cart, data, size);
     tic_api_reset(console->tic);
 
     studioRomLoaded(console->studio);
@@ -869,10 +869,10 @@ static void updateProject(Console* console)
         {
 #if defined(TIC80_PRO)
             if(project_ext(path))
-                tic_project_load(console->rom.name, data, size, &tic->cart);
+                tic_project_load(console->rom.name, data, size, tic->cart);
             else
 #endif
-                tic_cart_load(&tic->cart, data, size);
+                tic_cart_load(tic->cart, data, size);
 
             studioRomLoaded(console->studio);
         }
@@ -1196,7 +1196,7 @@ static void loadDemo(Console* console, const tic_script* script)
 
     if(data)
     {
-        tic_cart_load(&console->tic->cart, data, size);
+        tic_cart_load(console->tic->cart, data, size);
         tic_api_reset(console->tic);
 
         free(data);
@@ -1799,7 +1799,7 @@ static void onFileImported(Console* console, const char* filename, bool result)
 
 static inline tic_bank* getBank(Console* console, s32 bank)
 {
-    return &console->tic->cart.banks[bank];
+    return &console->tic->cart->banks[bank];
 }
 
 static inline const tic_palette* getPalette(Console* console, s32 bank, s32 vbank)
@@ -1843,33 +1843,38 @@ static void onImportTilesBase(Console* console, const char* name, const void* bu
         }
         u32 color1, color2, color3, color4, color;
 
-        for(s32 j = 0, y = params.y, h = y + (params.h ? params.h : img.height); y < h; ++y, ++j)
-            for(s32 i = 0, x = params.x, w = x + ((params.w ? params.w : img.width) / bpp_scale); x < w; ++x, i += bpp_scale)
-                if(x >= 0 && x < TIC_SPRITESHEET_SIZE && y >= 0 && y < TIC_SPRITESHEET_SIZE)
-                    switch (bpp) {
-                        case 4:
-                            setSpritePixel(base, x, y, tic_nearest_color(pal->colors,
-                               (tic_rgb*)(img.pixels + i + j * img.width), TIC_PALETTE_SIZE));
-                            break;
-                        case 2:
-                            color1 = tic_nearest_color(pal->colors, (tic_rgb*)(img.pixels + i + j * img.width), 4);
-                            color2 = tic_nearest_color(pal->colors, (tic_rgb*)(img.pixels + i + 1 + j * img.width), 4);
-                            // adding them together caused issues with squashing??? no idea why this isn't the case
-                            // for bpp 1
-                            color = (color2 << 2) | color1;
-                            setSpritePixel(base, x, y, color);
-                            break;
-                        case 1:
-                            color1 = tic_nearest_color(pal->colors, (tic_rgb*)(img.pixels + i + j * img.width), 2);
-                            color2 = tic_nearest_color(pal->colors, (tic_rgb*)(img.pixels + i + 1 + j * img.width), 2);
-                            color3 = tic_nearest_color(pal->colors, (tic_rgb*)(img.pixels + i + 2 + j * img.width), 2);
-                            color4 = tic_nearest_color(pal->colors, (tic_rgb*)(img.pixels + i + 3 + j * img.width), 2);
-                            color = (color4 << 3) | (color3 << 2) | (color2 << 1) | color1;
-                            setSpritePixel(base, x, y, color);
-                            break;
-                    }
+        tic_nearest* nearest = tic_nearest_create(pal->colors, 1 << bpp);
+
+        if(nearest) SCOPE(tic_nearest_close(nearest))
+        {
+            for(s32 j = 0, y = params.y, h = y + (params.h ? params.h : img.height); y < h; ++y, ++j)
+                for(s32 i = 0, x = params.x, w = x + ((params.w ? params.w : img.width) / bpp_scale); x < w; ++x, i += bpp_scale)
+                    if(x >= 0 && x < TIC_SPRITESHEET_SIZE && y >= 0 && y < TIC_SPRITESHEET_SIZE)
+                        switch (bpp) {
+                            case 4:
+                                setSpritePixel(base, x, y, tic_nearest_find(nearest,
+                                   (tic_rgb*)(img.pixels + i + j * img.width)));
+                                break;
+                            case 2:
+                                color1 = tic_nearest_find(nearest, (tic_rgb*)(img.pixels + i + j * img.width));
+                                color2 = tic_nearest_find(nearest, (tic_rgb*)(img.pixels + i + 1 + j * img.width));
+                                // adding them together caused issues with squashing??? no idea why this isn't the case
+                                // for bpp 1
+                                color = (color2 << 2) | color1;
+                                setSpritePixel(base, x, y, color);
+                                break;
+                            case 1:
+                                color1 = tic_nearest_find(nearest, (tic_rgb*)(img.pixels + i + j * img.width));
+                                color2 = tic_nearest_find(nearest, (tic_rgb*)(img.pixels + i + 1 + j * img.width));
+                                color3 = tic_nearest_find(nearest, (tic_rgb*)(img.pixels + i + 2 + j * img.width));
+                                color4 = tic_nearest_find(nearest, (tic_rgb*)(img.pixels + i + 3 + j * img.width));
+                                color = (color4 << 3) | (color3 << 2) | (color2 << 1) | color1;
+                                setSpritePixel(base, x, y, color);
+                                break;
+                        }
 
-        error = false;
+            error = false;
+        }
     }
 
 exit:
@@ -1887,7 +1892,7 @@ static void onImport_binary(Console* console, const char* name, const void* buff
 
     if(ok)
     {
-        tic_binary* binary = &console->tic->cart.binary;
+        tic_binary* binary = &console->tic->cart->binary;
         binary->size = size;
         memcpy(binary->data, buffer, size);
     }
@@ -1925,8 +1930,8 @@ static void onImport_code(Console* console, const char* name, const void* buffer
     {
         enum {Size = sizeof(tic_code)};
 
-        memset(tic->cart.code.data, 0, Size);
-        memcpy(tic->cart.code.data, buffer, MIN(size, Size));
+        memset(tic->cart->code.data, 0, Size);
+        memcpy(tic->cart->code.data, buffer, MIN(size, Size));
 
         studioRomLoaded(console->studio);
     }
@@ -1949,11 +1954,16 @@ static void onImport_screen(Console* console, const char* name, const void* buff
             tic_bank* bank = getBank(console, params.bank);
             const tic_palette* pal = getPalette(console, params.bank, params.vbank);
 
-            s32 i = 0;
-            for(const png_rgba *pix = img.pixels, *end = pix + (TIC80_WIDTH * TIC80_HEIGHT); pix < end; pix++)
-                tic_tool_poke4(bank->screen.data, i++, tic_nearest_color(pal->colors, (tic_rgb*)pix, TIC_PALETTE_SIZE));
+            tic_nearest* nearest = tic_nearest_create(pal->colors, TIC_PALETTE_SIZE);
 
-            error = false;
+            if(nearest) SCOPE(tic_nearest_close(nearest))
+            {
+                s32 i = 0;
+                for(const png_rgba *pix = img.pixels, *end = pix + (TIC80_WIDTH * TIC80_HEIGHT); pix < end; pix++)
+                    tic_tool_poke4(bank->screen.data, i++, tic_nearest_find(nearest, (tic_rgb*)pix));
+
+                error = false;
+            }
         }
     }
 
@@ -2048,7 +2058,7 @@ typedef struct
 static void exportSprites(Console* console, const char* filename, tic_tile* base, ExportParams params)
 {
     tic_mem* tic = console->tic;
-    const tic_cartridge* cart = &tic->cart;
+    const tic_cartridge* cart = tic->cart;
 
     png_img img = {TIC_SPRITESHEET_SIZE, TIC_SPRITESHEET_SIZE, malloc(TIC_SPRITESHEET_SIZE * TIC_SPRITESHEET_SIZE * sizeof(png_rgba))};
 
@@ -2072,40 +2082,34 @@ static void* embedCart(Console* console, u8* app, s32* size)
 {
     tic_mem* tic = console->tic;
     u8* data = NULL;
-    void* cart = newCart();
 
-    SCOPE(free(cart))
-    {
-        s32 cartSize = tic_cart_save(&tic->cart, cart);
+    s32 zipSize = sizeof(tic_cartridge);
+    u8* zipData = (u8*)malloc(zipSize);
 
-        s32 zipSize = sizeof(tic_cartridge);
-        u8* zipData = (u8*)malloc(zipSize);
-
-        SCOPE(free(zipData))
+    SCOPE(free(zipData))
+    {
+        if((zipSize = tic_cart_save_zip(tic->cart, zipData, zipSize, TIC_ZIP_BEST)))
         {
-            if((zipSize = tic_tool_zip(zipData, zipSize, cart, cartSize)))
-            {
-                s32 appSize = *size;
+            s32 appSize = *size;
 
-                EmbedHeader header =
-                {
-                    .appSize = appSize,
-                    .cartSize = zipSize,
-                };
+            EmbedHeader header =
+            {
+                .appSize = appSize,
+                .cartSize = zipSize,
+            };
 
-                memcpy(header.sig, CART_SIG, STRLEN(CART_SIG));
+            memcpy(header.sig, CART_SIG, STRLEN(CART_SIG));
 
-                s32 finalSize = appSize + sizeof header + header.cartSize;
-                data = malloc(finalSize);
+            s32 finalSize = appSize + sizeof header + header.cartSize;
+            data = malloc(finalSize);
 
-                if (data)
-                {
-                    memcpy(data, app, appSize);
-                    memcpy(data + appSize, &header, sizeof header);
-                    memcpy(data + appSize + sizeof header, zipData, header.cartSize);
+            if (data)
+            {
+                memcpy(data, app, appSize);
+                memcpy(data + appSize, &header, sizeof header);
+                memcpy(data + appSize + sizeof header, zipData, header.cartSize);
 
-                    *size = finalSize;
-                }
+                *size = finalSize;
             }
         }
     }
@@ -2233,7 +2237,7 @@ static void onHtmlExportGet(const net_get_data* data)
 
                     SCOPE(free(cart))
                     {
-                        s32 cartSize = tic_cart_save(&tic->cart, cart);
+                        s32 cartSize = tic_cart_save(tic->cart, cart);
 
                         if(cartSize)
                         {
@@ -2306,7 +2310,7 @@ static void onExport_binary(Console* console, const char* param, const char* pat
 {
     const char* filename = getFilename(path, ".binary");
 
-    tic_binary *binary = &console->tic->cart.binary;
+    tic_binary *binary = &console->tic->cart->binary;
     // TODO: do we need this buffer at all, could we just handle `binary.data` directly to `tic_fs_save`?
     void* buffer = malloc(binary->size);
 
@@ -2405,7 +2409,7 @@ static void onExport_screen(Console* console, const char* param, const char* nam
     const char* filename = getFilename(name, ".png");
 
     tic_mem* tic = console->tic;
-    const tic_cartridge* cart = &tic->cart;
+    const tic_cartridge* cart = tic->cart;
 
     png_img img = {TIC80_WIDTH, TIC80_HEIGHT, malloc(TIC80_WIDTH * TIC80_HEIGHT * sizeof(png_rgba))};
 
@@ -2479,7 +2483,8 @@ static void drawShadowText(tic_mem* tic, const char* text, s32 x, s32 y, tic_col
 
 const char* readMetatag(const char* code, const char* tag, const char* comment);
 
-static CartSaveResult saveCartName(Console* console, const char* name)
+// level is the deflate level of .png carts
+static CartSaveResult saveCartLevel(Console* console, const char* name, s32 level)
 {
     tic_mem* tic = console->tic;
 
@@ -2521,7 +2526,7 @@ static CartSaveResult saveCartName(Console* console, const char* name)
                         {
                             enum{PaddingLeft = 8, PaddingTop = 8};
 
-                            const tic_bank* bank = &tic->cart.bank0;
+                            const tic_bank* bank = &tic->cart->bank0;
                             const tic_rgb* pal = bank->palette.vbank0.colors;
                             const u8* screen = bank->screen.data;
                             u32* ptr = img.values + PaddingTop * CoverWidth + PaddingLeft;
@@ -2538,13 +2543,13 @@ static CartSaveResult saveCartName(Console* console, const char* name)
 
                             const char* comment = tic_get_script(tic)->singleComment;
 
-                            const char* title = tic_tool_metatag(tic->cart.code.data, "title", comment);
+                            const char* title = tic_tool_metatag(tic->cart->code.data, "title", comment);
                             if(*title)
                             {
                                 drawShadowText(tic, title, 0, 0, tic_color_white, Scale);
                             }
 
-                            const char* author = tic_tool_metatag(tic->cart.code.data, "author", comment);
+                            const char* author = tic_tool_metatag(tic->cart->code.data, "author", comment);
                             if(*author)
                             {
                                 char buf[TICNAME_MAX];
@@ -2573,13 +2578,7 @@ static CartSaveResult saveCartName(Console* console, const char* name)
                     }
 
                     png_buffer zip = png_create(sizeof(tic_cartridge));
-
-                    {
-                        png_buffer cart = png_create(sizeof(tic_cartridge));
-                        cart.size = tic_cart_save(&tic->cart, cart.data);
-                        zip.size = tic_tool_zip(zip.data, zip.size, cart.data, cart.size);
-                        free(cart.data);
-                    }
+                    zip.size = tic_cart_save_zip(tic->cart, zip.data, zip.size, level);
 
                     png_buffer result = png_encode(cover, zip);
                     free(zip.data);
@@ -2591,13 +2590,13 @@ static CartSaveResult saveCartName(Console* console, const char* name)
 #if defined(TIC80_PRO)
                 else if(project_ext(name))
                 {
-                    size = tic_project_save(name, buffer, &tic->cart);
+                    size = tic_project_save(name, buffer, tic->cart);
                 }
 #endif
                 else
                 {
                     name = getCartName(name);
-                    size = tic_cart_save(&tic->cart, buffer);
+                    size = tic_cart_save(tic->cart, buffer);
                 }
 
                 if(size && tic_fs_save(console->fs, name, buffer, size, true))
@@ -2613,13 +2612,18 @@ static CartSaveResult saveCartName(Console* console, const char* name)
     }
     else if (strlen(console->rom.name))
     {
-        return saveCartName(console, console->rom.name);
+        return saveCartLevel(console, console->rom.name, level);
     }
     else return CART_SAVE_MISSING_NAME;
 
     return success ? CART_SAVE_OK : CART_SAVE_ERROR;
 }
 
+static CartSaveResult saveCartName(Console* console, const char* name)
+{
+    return saveCartLevel(console, name, TIC_ZIP_BEST);
+}
+
 static CartSaveResult saveCart(Console* console)
 {
     return saveCartName(console, NULL);
@@ -2684,7 +2688,7 @@ static void onResumeCommand(Console* console)
             const tic_script* script_config = tic_get_script(console->tic);
             if (script_config->eval)
             {
-                script_config->eval(console->tic, console->tic->cart.code.data);
+                script_config->eval(console->tic, console->tic->cart->code.data);
             }
             else
             {
@@ -4483,20 +4487,20 @@ static bool cmdLoadCart(Console* console, const char* path)
 
             if(cart)
             {
-                memcpy(&tic->cart, cart, sizeof(tic_cartridge));
+                memcpy(tic->cart, cart, sizeof(tic_cartridge));
                 free(cart);
                 done = true;
             }
         }
         else if(tic_tool_has_ext(cartName, CART_EXT))
         {
-            tic_cart_load(&tic->cart, data, size);
+            tic_cart_load(tic->cart, data, size);
             done = true;
         }
 #if defined(TIC80_PRO)
         else if(project_ext(cartName))
         {
-            if(tic_project_load(cartName, data, size, &tic->cart))
+            if(tic_project_load(cartName, data, size, tic->cart))
                 done = true;
         }
 #endif
@@ -4515,7 +4519,9 @@ void forceAutoSave(Console* console, const char* cart_name)
     char namepath[TICNAME_MAX];
     strcpy(namepath, "/downloads/");
     strcat(namepath, cart_name);
-    CartSaveResult rom = saveCartName(console, namepath);
+
+    // autosave runs on every web cart load, don't stall on the best level
+    CartSaveResult rom = saveCartLevel(console, namepath, TIC_ZIP_FAST);
 
     if(rom == CART_SAVE_OK)
     {
@@ -23,7 +23,7 @@ static bool load(Console* console, const char* path)
 
     if(data) SCOPE(free(data))
     {
-        tic_cart_load(&console->tic->cart, data, size);
+        tic_cart_load(console->tic->cart, data, size);
         tic_api_reset(console->tic);
 
         {
@@ -58,7 +58,7 @@ static void loadByHashDone(const u8* buffer, s32 size, void* data)
     LoadByHashData* loadByHashData = data;
     Console* console = loadByHashData->console;
 
-    tic_cart_load(&console->tic->cart, buffer, size);
+    tic_cart_load(console->tic->cart, buffer, size);
     tic_api_reset(console->tic);
 
     strcpy(console->rom.name, loadByHashData->name);
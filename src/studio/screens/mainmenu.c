@@ -170,6 +170,44 @@ static MenuOption VSyncOption =
     optionVSyncSet,
 };
 
+static s32 optionFrameskipGet(void* data)
+{
+    StudioMainMenu* main = data;
+    return main->options->frameskip;
+}
+
+static void optionFrameskipSet(void* data, s32 pos)
+{
+    StudioMainMenu* main = data;
+    main->options->frameskip = pos;
+}
+
+static MenuOption FrameskipOption =
+{
+    OPTION_VALUES({OffValue, "1", "2", "3", "4"}),
+    optionFrameskipGet,
+    optionFrameskipSet,
+};
+
+static s32 optionFpsGet(void* data)
+{
+    StudioMainMenu* main = data;
+    return main->options->fps ? 1 : 0;
+}
+
+static void optionFpsSet(void* data, s32 pos)
+{
+    StudioMainMenu* main = data;
+    main->options->fps = pos == 1;
+}
+
+static MenuOption FpsOption =
+{
+    OPTION_VALUES({OffValue, OnValue}),
+    optionFpsGet,
+    optionFpsSet,
+};
+
 static s32 optionVolumeGet(void* data)
 {
     StudioMainMenu* main = data;
@@ -305,6 +343,8 @@ enum
     OptionsMenu_CrtMonitorOption,
 #endif
     OptionsMenu_VSyncOption,
+    OptionsMenu_FrameskipOption,
+    OptionsMenu_FpsOption,
     OptionsMenu_FullscreenOption,
     OptionsMenu_IntegerScaleOption,
     OptionsMenu_VolumeOption,
@@ -322,6 +362,8 @@ static const MenuItem OptionMenu[] =
     {"CRT MONITOR",     NULL,   &CrtMonitorOption},
 #endif
     {"VSYNC",           NULL,   &VSyncOption, "VSYNC needs restart!"},
+    {"FRAMESKIP",       NULL,   &FrameskipOption, "Max frames to skip when too slow"},
+    {"SHOW FPS",        NULL,   &FpsOption},
     {"FULLSCREEN",      NULL,   &FullscreenOption},
     {"INTEGER SCALE",   NULL,   &IntegerScaleOption},
     {"VOLUME",          NULL,   &VolumeOption},
@@ -395,7 +437,7 @@ static void initGameMenu(StudioMainMenu* main)
 
     freeItems(main);
 
-    const char* value = tic_tool_metatag(tic->cart.code.data, "menu", tic_get_script(tic)->singleComment);
+    const char* value = tic_tool_metatag(tic->cart->code.data, "menu", tic_get_script(tic)->singleComment);
 
     if(*value)
     {
@@ -23,6 +23,10 @@
 #include "run.h"
 #include "console.h"
 #include "studio/fs.h"
+#include "studio/cache.h"
+#include "studio/rewind.h"
+#include "replay.h"
+#include "netplay.h"
 #include "ext/md5.h"
 #include <time.h>
 
@@ -81,7 +85,7 @@ static void initPMemName(Run* run)
 {
     tic_mem* tic = run->tic;
 
-    const void* data = &tic->cart.bank0;
+    const void* data = &tic->cart->bank0;
     s32 dataSize = sizeof(tic_bank);
 
     if(strlen(tic->saveid))
@@ -96,6 +100,180 @@ static void initPMemName(Run* run)
     strcat(run->saveid, md5);
 }
 
+static void storeRewind(Run* run)
+{
+    // carts with runtimes that can't be saved aren't recorded
+    s32 size = tic_core_state_size(run->tic);
+
+    if(size)
+    {
+        tic_core_state_save(run->tic, tic_rewind_begin(run->rewind, size), size);
+        tic_rewind_end(run->rewind);
+    }
+}
+
+static void rewindGame(Run* run)
+{
+    const void* state = tic_rewind_back(run->rewind, 1);
+
+    if(state)
+        tic_core_state_load(run->tic, state, tic_core_state_size(run->tic));
+}
+
+// the cart sees the clock and the random seed from the replay,
+// so playing it back gives the same frames
+static void recordGame(Run* run)
+{
+    tic_mem* tic = run->tic;
+
+    if(!run->replay)
+    {
+        tic_replay_header header =
+        {
+            .seed = (u32)time(NULL),
+            .cart = tic_replay_cart(tic->cart),
+            .mapping = tic->ram->mapping,
+            .persistent = tic->ram->persistent,
+        };
+
+        run->replay = tic_replay_create(&header);
+        run->replayStart = tic_sys_counter_get();
+        tic_core_seed(tic, header.seed);
+    }
+
+    tic_replay_frame frame =
+    {
+        .input = tic->ram->input,
+        .time = (u64)((double)(tic_sys_counter_get() - run->replayStart) * 1000000.0 / tic_sys_freq_get()),
+        .tstamp = (s32)time(NULL),
+    };
+
+    tic_replay_clock(&run->tickData, &frame);
+    tic_core_tick(tic, &run->tickData);
+
+    frame.hash = tic_replay_hash(tic);
+    tic_replay_add(run->replay, &frame);
+}
+
+static void saveReplay(Run* run)
+{
+    if(run->replay)
+    {
+        s32 size = 0;
+        void* data = tic_replay_save(run->replay, &size);
+
+        FILE* file = fopen(run->record, "wb");
+
+        if(file)
+        {
+            fwrite(data, 1, size, file);
+            fclose(file);
+        }
+
+        free(data);
+        tic_replay_close(run->replay);
+        run->replay = NULL;
+    }
+}
+
+static void netplayTick(void* data, tic80_gamepads gamepads, bool hidden)
+{
+    Run* run = (Run*)data;
+    tic_mem* tic = run->tic;
+    tic80_input* input = &tic->ram->input;
+
+    // only the gamepads are shared, the peers would drift apart on the rest
+    input->gamepads = gamepads;
+    ZEROMEM(input->mouse);
+    ZEROMEM(input->keyboard);
+
+    tic_core_tick_start(tic);
+    tic_core_tick(tic, &run->tickData);
+    tic_core_tick_end(tic);
+
+    // the studio blits the shown frame
+    if(hidden)
+        tic_core_blit_skip(tic);
+}
+
+static bool openNetplay(Run* run)
+{
+#if defined(TIC80_NETPLAY_UDP)
+    char peers[1024];
+    const char* list[TIC_NETPLAY_PLAYERS];
+    s32 players = 0;
+
+    strncpy(peers, run->netplay.peers, sizeof peers - 1);
+    peers[sizeof peers - 1] = '\0';
+
+    for(char* peer = strtok(peers, ","); peer && players < COUNT_OF(list); peer = strtok(NULL, ","))
+        list[players++] = peer;
+
+    tic_netplay_transport transport;
+    if(tic_netplay_udp(&transport, list, players, run->netplay.player))
+    {
+        run->netplay.session = tic_netplay_create(players, run->netplay.player, run->netplay.delay,
+            tic_replay_cart(run->tic->cart), transport);
+
+        if(!run->netplay.session)
+            transport.close(transport.data);
+    }
+#endif
+
+    return run->netplay.session != NULL;
+}
+
+static void closeNetplay(Run* run)
+{
+    if(run->netplay.session)
+    {
+        tic_netplay_close(run->netplay.session);
+        run->netplay.session = NULL;
+
+        // back to the local saves
+        memcpy(run->tic->ram->persistent.data, run->pmem.data, sizeof(tic_persistent));
+    }
+}
+
+// the local players use the first gamepad whatever their number in the session is,
+// the frames wait for the peers before the cart starts and when they fall behind
+static void netplayGame(Run* run)
+{
+    tic_mem* tic = run->tic;
+
+    if(!run->netplay.session && !openNetplay(run))
+    {
+        run->netplay.peers = NULL;
+        onError(run, "can't start the netplay session");
+        return;
+    }
+
+    tic_netplay* session = run->netplay.session;
+
+    if(tic_netplay_refused(session))
+    {
+        closeNetplay(run);
+        run->netplay.peers = NULL;
+        onError(run, "a netplay peer runs another cart");
+        return;
+    }
+
+    if(tic_netplay_input(session, tic->ram->input.gamepads.first))
+    {
+        if(tic_netplay_frame(session) == 0)
+        {
+            u32 seed = tic_netplay_seed(session);
+
+            // every peer has its own saves, the session starts with none
+            ZEROMEM(tic->ram->persistent);
+            tic_core_seed(tic, seed);
+            run->tickData.clock = (tic80_clock){.mode = TIC80_CLOCK_FRAMES, .tstamp = (s32)seed};
+        }
+
+        tic_netplay_advance(session, tic, netplayTick, run);
+    }
+}
+
 static void tick(Run* run)
 {
     if (getStudioMode(run->studio) != TIC_RUN_MODE)
@@ -103,11 +281,25 @@ static void tick(Run* run)
 
     tic_mem* tic = run->tic;
 
-    tic_core_tick(tic, &run->tickData);
+    if(run->netplay.peers)
+        netplayGame(run);
+    else if(run->record)
+        recordGame(run);
+    // hold CTRL+BACKSPACE to play the game backwards
+    else if(run->rewind && tic_api_key(tic, tic_key_ctrl) && tic_api_key(tic, tic_key_backspace))
+        rewindGame(run);
+    else
+    {
+        tic_core_tick(tic, &run->tickData);
+
+        if(run->rewind)
+            storeRewind(run);
+    }
 
     enum {Size = sizeof(tic_persistent)};
 
-    if(memcmp(run->pmem.data, tic->ram->persistent.data, Size))
+    // the netplay saves belong to the session and aren't kept
+    if(!run->netplay.session && memcmp(run->pmem.data, tic->ram->persistent.data, Size))
     {
         tic_fs_saveroot(run->fs, run->saveid, &tic->ram->persistent, Size, true);
         memcpy(run->pmem.data, tic->ram->persistent.data, Size);
@@ -131,11 +323,47 @@ static u64 getCounter(void* data)
     return tic_sys_counter_get();
 }
 
+static void* loadCache(void* data, const char* key, s32* size)
+{
+    Run* run = (Run*)data;
+
+    char name[TICNAME_MAX];
+    snprintf(name, sizeof name, "%s.bc", key);
+
+    return tic_cache_load(tic_fs_cache(run->fs), name, size);
+}
+
+static void saveCache(void* data, const char* key, const void* buffer, s32 size)
+{
+    Run* run = (Run*)data;
+
+    char name[TICNAME_MAX];
+    snprintf(name, sizeof name, "%s.bc", key);
+
+    tic_cache_save(tic_fs_cache(run->fs), name, buffer, size);
+}
+
 void initRun(Run* run, Console* console, tic_fs* fs, Studio* studio)
 {
+    struct tic_rewind* rewind = run->rewind;
+    const char* record = run->record;
+
+    if(rewind)
+        tic_rewind_clear(rewind);
+
+    saveReplay(run);
+    closeNetplay(run);
+
+    const char* peers = run->netplay.peers;
+    s32 player = run->netplay.player;
+    s32 delay = run->netplay.delay;
+
     *run = (Run)
     {
         .studio = studio,
+        .rewind = rewind,
+        .record = record,
+        .netplay = {peers, player, delay},
         .tic = getMemory(studio),
         .console = console,
         .fs = fs,
@@ -148,7 +376,12 @@ void initRun(Run* run, Console* console, tic_fs* fs, Studio* studio)
             .exit = onExit,
             .data = run,
             .counter = getCounter,
-            .freq = getFreq
+            .freq = getFreq,
+            .cache =
+            {
+                .load = loadCache,
+                .save = saveCache,
+            },
         },
     };
 
@@ -175,5 +408,11 @@ void initRun(Run* run, Console* console, tic_fs* fs, Studio* studio)
 
 void freeRun(Run* run)
 {
+    saveReplay(run);
+    closeNetplay(run);
+
+    if(run->rewind)
+        tic_rewind_close(run->rewind);
+
     free(run);
 }
\ No newline at end of file
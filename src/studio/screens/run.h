@@ -40,6 +40,24 @@ struct Run
     char saveid[TICNAME_MAX];
     tic_persistent pmem;
 
+    // kept between runs, NULL if rewind is off
+    struct tic_rewind* rewind;
+
+    // the session is recorded to this file if it's set
+    const char* record;
+    struct tic_replay* replay;
+    u64 replayStart;
+
+    // the game is played over the network if the peers are set,
+    // a session lasts for one run of the cart
+    struct
+    {
+        const char* peers;
+        s32 player;
+        s32 delay;
+        struct tic_netplay* session;
+    } netplay;
+
     void(*tick)(Run*);
 };
 
@@ -165,7 +165,7 @@ void initStart(Start* start, Studio* studio, const char* cart)
 
         if(data) SCOPE(free(data))
         {
-            tic_cart_load(&start->tic->cart, data, size);
+            tic_cart_load(start->tic->cart, data, size);
             tic_api_reset(start->tic);
             start->embed = true;
         }
@@ -200,7 +200,7 @@ void initStart(Start* start, Studio* studio, const char* cart)
 
                             if(dataSize)
                             {
-                                tic_cart_load(&start->tic->cart, data, dataSize);
+                                tic_cart_load(start->tic->cart, data, dataSize);
                                 tic_api_reset(start->tic);
                                 start->embed = true;
                             }
@@ -22,6 +22,7 @@
 
 #include "surf.h"
 #include "studio/fs.h"
+#include "studio/cache.h"
 #include "studio/net.h"
 #include "studio/config.h"
 #include "console.h"
@@ -48,11 +49,13 @@
 #define COVER_X (TIC80_WIDTH - COVER_WIDTH - COVER_Y)
 #define COVER_FADEIN 96
 #define COVER_FADEOUT 256
+#define COVER_PREFETCH 3
 #define CAN_OPEN_URL (__TIC_WINDOWS__ || __TIC_LINUX__ || __TIC_MACOSX__ || __TIC_ANDROID__)
 
 static const char* PngExt = PNG_EXT;
 
 typedef struct SurfItem SurfItem;
+typedef struct SurfDecoder SurfDecoder;
 
 struct SurfItem
 {
@@ -65,6 +68,7 @@ struct SurfItem
     tic_palette* palette;
 
     bool coverLoading;
+    bool coverRequested;
     bool dir;
     bool project;
 };
@@ -274,180 +278,384 @@ static void addMenuItemsDone(void* data)
     surf->loading = false;
 }
 
-static void resetMenu(Surf* surf)
+typedef enum
 {
-    if(surf->menu.items)
-    {
-        for(s32 i = 0; i < surf->menu.count; i++)
-        {
-            SurfItem* item = &surf->menu.items[i];
+    CoverGif,
+    CoverCart,
+#if defined(TIC80_PRO)
+    CoverProject,
+#endif
+} CoverType;
 
-            free(item->name);
+typedef struct CoverJob CoverJob;
 
-            FREE(item->hash);
-            FREE(item->cover);
-            FREE(item->label);
-            FREE(item->palette);
-        }
+struct CoverJob
+{
+    CoverType type;
+    u32 generation;
+    s32 pos;
 
-        free(surf->menu.items);
+    // gif data or the path of the cart to read
+    u8* data;
+    s32 size;
+    char path[TICNAME_MAX];
 
-        surf->menu.items = NULL;
-        surf->menu.count = 0;
-    }
+    tic_screen* cover;
+    tic_palette* palette;
 
-    surf->menu.pos = 0;
-}
+    CoverJob* next;
+};
 
-static void updateMenuItemCover(Surf* surf, s32 pos, const u8* cover, s32 size)
+struct SurfDecoder
 {
-    SurfItem* item = &surf->menu.items[pos];
+    void* thread;
+    void* lock;
+    void* signal;
+
+    CoverJob* queue;
+    CoverJob* done;
+
+    u32 generation;
+    bool quit;
+};
+
+static void setJobCover(CoverJob* job, const tic_screen* screen, const tic_palette* palette)
+{
+    memcpy((job->palette = malloc(sizeof(tic_palette))), palette, sizeof(tic_palette));
+    memcpy((job->cover = malloc(sizeof(tic_screen))), screen, sizeof(tic_screen));
+}
 
-    gif_image* image = gif_read_data(cover, size);
+static void decodeGif(CoverJob* job)
+{
+    gif_image* image = gif_read_data(job->data, job->size);
 
     if(image)
     {
-        item->cover = malloc(sizeof(tic_screen));
-        item->palette = malloc(sizeof(tic_palette));
+        tic_screen screen = {0};
+        tic_palette palette = {0};
 
         if (image->width == TIC80_WIDTH
             && image->height == TIC80_HEIGHT
             && image->colors <= TIC_PALETTE_SIZE)
         {
-            memcpy(item->palette, image->palette, image->colors * sizeof(tic_rgb));
+            memcpy(&palette, image->palette, image->colors * sizeof(tic_rgb));
 
             for(s32 i = 0; i < TIC80_WIDTH * TIC80_HEIGHT; i++)
-                tic_tool_poke4(item->cover->data, i, image->buffer[i]);
+                tic_tool_poke4(screen.data, i, image->buffer[i]);
+        }
+
+        setJobCover(job, &screen, &palette);
+
+        gif_close(image);
+    }
+}
+
+static void decodeCart(CoverJob* job)
+{
+    s32 size = 0;
+    void* data = fs_read(job->path, &size);
+
+    if(data)
+    {
+#if defined(TIC80_PRO)
+        if(job->type == CoverProject)
+        {
+            tic_cartridge* cart = (tic_cartridge*)malloc(sizeof(tic_cartridge));
+
+            if(cart)
+            {
+                tic_project_load(job->path, data, size, cart);
+
+                if(!EMPTY(cart->bank0.screen.data) && !EMPTY(cart->bank0.palette.vbank0.data))
+                    setJobCover(job, &cart->bank0.screen, &cart->bank0.palette.vbank0);
+
+                free(cart);
+            }
         }
         else
+#endif
         {
-            memset(item->cover, 0, sizeof(tic_screen));
-            memset(item->palette, 0, sizeof(tic_palette));
+            // only the cover and the palette are needed here
+            tic_cart_reader* reader = tic_cart_reader_open(data, size);
+
+            if(reader)
+            {
+                tic_screen screen;
+                tic_palettes palette;
+
+                if(tic_cart_read_screen(reader, 0, &screen) && !EMPTY(screen.data)
+                    && tic_cart_read_palette(reader, 0, &palette) && !EMPTY(palette.vbank0.data))
+                    setJobCover(job, &screen, &palette.vbank0);
+
+                tic_cart_reader_close(reader);
+            }
         }
 
-        gif_close(image);
+        free(data);
     }
 }
 
-typedef struct
+static void decodeCover(CoverJob* job)
 {
-    Surf* surf;
-    s32 pos;
-    char cachePath[TICNAME_MAX];
-    char dir[TICNAME_MAX];
-} CoverLoadingData;
+    switch(job->type)
+    {
+    case CoverGif: decodeGif(job); break;
+    default: decodeCart(job); break;
+    }
 
-static void coverLoaded(const net_get_data* netData)
-{
-    CoverLoadingData* coverLoadingData = netData->calldata;
-    Surf* surf = coverLoadingData->surf;
+    FREE(job->data);
+    job->data = NULL;
+}
 
-    if (netData->type == net_get_done)
+static void freeJobs(CoverJob* job)
+{
+    while(job)
     {
-        tic_fs_saveroot(surf->fs, coverLoadingData->cachePath, netData->done.data, netData->done.size, false);
+        CoverJob* next = job->next;
 
-        char dir[TICNAME_MAX];
-        tic_fs_dir(surf->fs, dir);
+        FREE(job->data);
+        FREE(job->cover);
+        FREE(job->palette);
+        free(job);
 
-        if(strcmp(dir, coverLoadingData->dir) == 0)
-            updateMenuItemCover(surf, coverLoadingData->pos, netData->done.data, netData->done.size);
+        job = next;
     }
+}
 
-    switch (netData->type)
-    {
-    case net_get_done:
-    case net_get_error:
-        free(coverLoadingData);
-        break;
-    default: break;
-    }
+static void lockDecoder(SurfDecoder* decoder)
+{
+    if(decoder->thread)
+        tic_sys_sem_wait(decoder->lock);
 }
 
-static void requestCover(Surf* surf, SurfItem* item)
+static void unlockDecoder(SurfDecoder* decoder)
 {
-    CoverLoadingData coverLoadingData = {surf, surf->menu.pos};
-    tic_fs_dir(surf->fs, coverLoadingData.dir);
+    if(decoder->thread)
+        tic_sys_sem_post(decoder->lock);
+}
 
-    const char* hash = item->hash;
-    sprintf(coverLoadingData.cachePath, TIC_CACHE "%s.gif", hash);
+static s32 decoderThread(void* data)
+{
+    SurfDecoder* decoder = data;
 
+    for(;;)
     {
-        s32 size = 0;
-        void* data = tic_fs_loadroot(surf->fs, coverLoadingData.cachePath, &size);
+        tic_sys_sem_wait(decoder->signal);
+
+        lockDecoder(decoder);
+
+        if(decoder->quit)
+        {
+            unlockDecoder(decoder);
+            break;
+        }
+
+        CoverJob* job = decoder->queue;
 
-        if (data)
+        if(job)
+            decoder->queue = job->next;
+
+        unlockDecoder(decoder);
+
+        if(job)
         {
-            updateMenuItemCover(surf, surf->menu.pos, data, size);
-            free(data);
+            decodeCover(job);
+
+            lockDecoder(decoder);
+            job->next = decoder->done;
+            decoder->done = job;
+            unlockDecoder(decoder);
         }
     }
 
-    char path[TICNAME_MAX];
-    sprintf(path, "/cart/%s/cover.gif", hash);
+    return 0;
+}
+
+static SurfDecoder* createDecoder()
+{
+    SurfDecoder* decoder = calloc(1, sizeof(SurfDecoder));
+
+    decoder->lock = tic_sys_sem_create(1);
+    decoder->signal = tic_sys_sem_create(0);
+
+    if(decoder->lock && decoder->signal)
+        decoder->thread = tic_sys_thread_create(decoderThread, decoder);
 
-    tic_net_get(surf->net, path, coverLoaded, MOVE(coverLoadingData));
+    return decoder;
 }
 
-static void loadCover(Surf* surf)
+static void closeDecoder(SurfDecoder* decoder)
 {
-    tic_mem* tic = surf->tic;
+    if(decoder->thread)
+    {
+        lockDecoder(decoder);
+        decoder->quit = true;
+        unlockDecoder(decoder);
 
-    SurfItem* item = getMenuItem(surf);
+        tic_sys_sem_post(decoder->signal);
+        tic_sys_thread_join(decoder->thread);
+    }
+
+    freeJobs(decoder->queue);
+    freeJobs(decoder->done);
+
+    if(decoder->lock) tic_sys_sem_free(decoder->lock);
+    if(decoder->signal) tic_sys_sem_free(decoder->signal);
+
+    free(decoder);
+}
+
+// results of queued jobs are dropped once the menu is rebuilt
+static void resetDecoder(SurfDecoder* decoder)
+{
+    lockDecoder(decoder);
+
+    freeJobs(decoder->queue);
+    decoder->queue = NULL;
+    decoder->generation++;
+
+    unlockDecoder(decoder);
+}
+
+static void submitCover(Surf* surf, s32 pos, CoverJob job, bool urgent)
+{
+    SurfDecoder* decoder = surf->decoder;
 
-    if(item->coverLoading)
+    surf->menu.items[pos].coverLoading = true;
+
+    job.generation = decoder->generation;
+    job.pos = pos;
+
+    CoverJob* ptr = MOVE(job);
+
+    if(!decoder->thread)
+    {
+        decodeCover(ptr);
+        ptr->next = decoder->done;
+        decoder->done = ptr;
         return;
+    }
 
-    item->coverLoading = true;
+    lockDecoder(decoder);
 
-    if(!tic_fs_ispubdir(surf->fs))
+    if(urgent || !decoder->queue)
     {
+        ptr->next = decoder->queue;
+        decoder->queue = ptr;
+    }
+    else
+    {
+        CoverJob* tail = decoder->queue;
+        while(tail->next) tail = tail->next;
+        tail->next = ptr;
+    }
 
-        s32 size = 0;
-        void* data = tic_fs_load(surf->fs, item->name, &size);
+    unlockDecoder(decoder);
 
-        if(data)
+    tic_sys_sem_post(decoder->signal);
+}
+
+static void receiveCovers(Surf* surf)
+{
+    SurfDecoder* decoder = surf->decoder;
+
+    lockDecoder(decoder);
+    CoverJob* job = decoder->done;
+    decoder->done = NULL;
+    unlockDecoder(decoder);
+
+    for(CoverJob* ptr = job; ptr; ptr = ptr->next)
+    {
+        if(ptr->generation == decoder->generation && ptr->pos < surf->menu.count)
         {
-            tic_cartridge* cart = (tic_cartridge*)malloc(sizeof(tic_cartridge));
+            SurfItem* item = &surf->menu.items[ptr->pos];
 
-            if(cart)
+            if(!item->cover && ptr->cover)
             {
+                item->cover = ptr->cover;
+                item->palette = ptr->palette;
+                ptr->cover = NULL;
+                ptr->palette = NULL;
+            }
+        }
+    }
 
-                if(tic_tool_has_ext(item->name, PngExt))
-                {
-                    tic_cartridge* pngcart = loadPngCart((png_buffer){data, size});
-
-                    if(pngcart)
-                    {
-                        memcpy(cart, pngcart, sizeof(tic_cartridge));
-                        free(pngcart);
-                    }
-                    else memset(cart, 0, sizeof(tic_cartridge));
-                }
-#if defined(TIC80_PRO)
-                else if(project_ext(item->name))
-                    tic_project_load(item->name, data, size, cart);
-#endif
-                else
-                    tic_cart_load(cart, data, size);
+    freeJobs(job);
+}
 
-                if(!EMPTY(cart->bank0.screen.data) && !EMPTY(cart->bank0.palette.vbank0.data))
-                {
-                    memcpy((item->palette = malloc(sizeof(tic_palette))), &cart->bank0.palette.vbank0, sizeof(tic_palette));
-                    memcpy((item->cover = malloc(sizeof(tic_screen))), &cart->bank0.screen, sizeof(tic_screen));
-                }
+static void resetMenu(Surf* surf)
+{
+    if(surf->menu.items)
+    {
+        for(s32 i = 0; i < surf->menu.count; i++)
+        {
+            SurfItem* item = &surf->menu.items[i];
 
-                free(cart);
-            }
+            free(item->name);
 
-            free(data);
+            FREE(item->hash);
+            FREE(item->cover);
+            FREE(item->label);
+            FREE(item->palette);
         }
+
+        free(surf->menu.items);
+
+        surf->menu.items = NULL;
+        surf->menu.count = 0;
     }
-    else if(item->hash && !item->cover)
+
+    surf->menu.pos = 0;
+
+    if(surf->decoder)
+        resetDecoder(surf->decoder);
+}
+
+static void requestCover(Surf* surf, s32 pos, bool urgent)
+{
+    SurfItem* item = &surf->menu.items[pos];
+
+    if(item->dir || item->cover || item->coverLoading)
+        return;
+
+    if(!tic_fs_ispubdir(surf->fs))
     {
-        requestCover(surf, item);
+        CoverJob job = {CoverCart};
+
+#if defined(TIC80_PRO)
+        if(project_ext(item->name))
+            job.type = CoverProject;
+#endif
+
+        strncpy(job.path, tic_fs_path(surf->fs, item->name), sizeof job.path - 1);
+        submitCover(surf, pos, job, urgent);
+    }
+    else if(item->hash)
+    {
+        char key[TICNAME_MAX];
+        snprintf(key, sizeof key, "%s.gif", item->hash);
+
+        tic_cache* cache = tic_fs_cache(surf->fs);
+
+        // the download goes to the cache, the cover is picked up from there on a later tick
+        if(tic_cache_has(cache, key))
+        {
+            CoverJob job = {CoverGif};
+
+            if((job.data = tic_cache_load(cache, key, &job.size)))
+                submitCover(surf, pos, job, urgent);
+        }
+        else if(!item->coverRequested)
+            item->coverRequested = tic_fs_hashprefetch(surf->fs, "cover.gif", item->hash);
     }
 }
 
+static void loadCover(Surf* surf)
+{
+    requestCover(surf, surf->menu.pos, true);
+    receiveCovers(surf);
+}
+
 static void initItemsAsync(Surf* surf, fs_done_callback callback, void* calldata)
 {
     resetMenu(surf);
@@ -635,10 +843,23 @@ static void loadCart(Surf* surf)
     else surf->anim.movie = resetMovie(&surf->anim.play);
 }
 
+static void prefetchCovers(Surf* surf, s32 dir)
+{
+    for(s32 i = 1; i <= COVER_PREFETCH; i++)
+    {
+        s32 pos = surf->menu.target + (dir < 0 ? -i : i);
+
+        if(pos >= 0 && pos < surf->menu.count)
+            requestCover(surf, pos, false);
+    }
+}
+
 static void move(Surf* surf, s32 dir)
 {
     surf->menu.target = (surf->menu.pos + surf->menu.count + dir) % surf->menu.count;
 
+    prefetchCovers(surf, dir);
+
     Anim* anim = surf->anim.move.items;
     anim->end = (surf->menu.target - surf->menu.pos) * MENU_HEIGHT;
 
@@ -855,6 +1076,9 @@ void initSurf(Surf* surf, Studio* studio, struct Console* console)
 {
     freeAnim(surf);
 
+    SurfDecoder* decoder = surf->decoder ? surf->decoder : createDecoder();
+    resetDecoder(decoder);
+
     *surf = (Surf)
     {
         .studio = studio,
@@ -929,6 +1153,7 @@ void initSurf(Surf* surf, Studio* studio, struct Console* console)
             },
         },
         .scanline = scanline,
+        .decoder = decoder,
     };
 
     surf->anim.movie = resetMovie(&surf->anim.idle);
@@ -940,5 +1165,9 @@ void freeSurf(Surf* surf)
 {
     freeAnim(surf);
     resetMenu(surf);
+
+    if(surf->decoder)
+        closeDecoder(surf->decoder);
+
     free(surf);
 }
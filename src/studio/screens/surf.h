@@ -47,6 +47,8 @@ struct Surf
         s32 count;
     } menu;
 
+    struct SurfDecoder* decoder;
+
     struct
     {
         struct
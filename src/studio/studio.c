@@ -63,6 +63,7 @@
 #include "screens/mainmenu.h"
 
 #include "fs.h"
+#include "rewind.h"
 
 #include "argparse.h"
 
@@ -226,6 +227,8 @@ struct Studio
 
     World*      world;
     Bytebattle bytebattle;
+
+    tic_cart_sizer* sizer;
 #endif
 
 #if defined(BUILD_EDITORS) || defined(BUILD_SURF)
@@ -248,6 +251,13 @@ struct Studio
     s32 samplerate;
     tic_font systemFont;
 
+    struct
+    {
+        s32 frames;
+        s32 ticks;
+        tic_gc_stats gc;
+    } fps;
+
 };
 
 static void emptyDone(void* data) {}
@@ -293,13 +303,13 @@ s32 calcWaveAnimation(tic_mem* tic, u32 offset, s32 channel)
 static const tic_sfx* getSfxSrc(Studio* studio)
 {
     tic_mem* tic = studio->tic;
-    return &tic->cart.banks[studio->bank.index.sfx].sfx;
+    return &tic->cart->banks[studio->bank.index.sfx].sfx;
 }
 
 static const tic_music* getMusicSrc(Studio* studio)
 {
     tic_mem* tic = studio->tic;
-    return &tic->cart.banks[studio->bank.index.music].music;
+    return &tic->cart->banks[studio->bank.index.music].music;
 }
 
 const char* studioExportSfx(Studio* studio, s32 index, const char* filename)
@@ -505,23 +515,23 @@ bool anyKeyWasPressed(Studio* studio)
 #if defined(BUILD_EDITORS)
 tic_tiles* getBankTiles(Studio* studio)
 {
-    return &studio->tic->cart.banks[studio->bank.index.sprites].tiles;
+    return &studio->tic->cart->banks[studio->bank.index.sprites].tiles;
 }
 
 tic_map* getBankMap(Studio* studio)
 {
-    return &studio->tic->cart.banks[studio->bank.index.map].map;
+    return &studio->tic->cart->banks[studio->bank.index.map].map;
 }
 
 tic_palette* getBankPalette(Studio* studio, bool vbank)
 {
-    tic_bank* bank = &studio->tic->cart.banks[studio->bank.index.sprites];
+    tic_bank* bank = &studio->tic->cart->banks[studio->bank.index.sprites];
     return vbank ? &bank->palette.vbank1 : &bank->palette.vbank0;
 }
 
 tic_flags* getBankFlags(Studio* studio)
 {
-    return &studio->tic->cart.banks[studio->bank.index.sprites].flags;
+    return &studio->tic->cart->banks[studio->bank.index.sprites].flags;
 }
 #endif
 
@@ -1033,6 +1043,24 @@ static void drawPopup(Studio* studio)
     }
 }
 
+// the zipped size of the cart as a .png cart would keep it, between the editor name
+// and the extra buttons, the sizer only compresses the sections edited since the last frame
+static void drawCartSize(Studio* studio, tic_mem* tic, s32 left)
+{
+    enum {Size = 7, Right = (COUNT_OF(Modes) + 1) * Size + 17 * TIC_FONT_WIDTH - 2};
+
+    if(!studio->sizer)
+        return;
+
+    char text[16];
+    snprintf(text, sizeof text, "%iK", (tic_cart_sizer_estimate(studio->sizer, tic->cart) + 1023) / 1024);
+
+    s32 x = Right - (s32)strlen(text) * TIC_FONT_WIDTH;
+
+    if(x > left)
+        tic_api_print(tic, text, x, 1, tic_color_light_grey, false, 1, false);
+}
+
 void drawToolbar(Studio* studio, tic_mem* tic, bool bg)
 {
     if(bg)
@@ -1102,6 +1130,7 @@ void drawToolbar(Studio* studio, tic_mem* tic, bool bg)
         else
         {
             tic_api_print(tic, Names[mode], TextOffset, 1, tic_color_grey, false, 1, false);
+            drawCartSize(studio, tic, TextOffset + (s32)strlen(Names[mode]) * TIC_FONT_WIDTH);
         }
     }
 }
@@ -1531,10 +1560,10 @@ static void initModules(Studio* studio)
 
     for(s32 i = 0; i < TIC_EDITOR_BANKS; i++)
     {
-        initSprite(studio->banks.sprite[i], studio, &tic->cart.banks[i].tiles);
-        initMap(studio->banks.map[i], studio, &tic->cart.banks[i].map);
-        initSfx(studio->banks.sfx[i], studio, &tic->cart.banks[i].sfx);
-        initMusic(studio->banks.music[i], studio, &tic->cart.banks[i].music);
+        initSprite(studio->banks.sprite[i], studio, &tic->cart->banks[i].tiles);
+        initMap(studio->banks.map[i], studio, &tic->cart->banks[i].map);
+        initSfx(studio->banks.sfx[i], studio, &tic->cart->banks[i].sfx);
+        initMusic(studio->banks.music[i], studio, &tic->cart->banks[i].music);
     }
 
     initWorldMap(studio);
@@ -1543,7 +1572,7 @@ static void initModules(Studio* studio)
 
 static void updateHash(Studio* studio)
 {
-    md5(&studio->tic->cart, sizeof(tic_cartridge), studio->cart.hash.data);
+    md5(studio->tic->cart, sizeof(tic_cartridge), studio->cart.hash.data);
 }
 
 static void updateMDate(Studio* studio)
@@ -1598,7 +1627,7 @@ bool studioCartChanged(Studio* studio)
     CartHash hash;
     if (!studio_is_cart_loaded(studio)) return false;
 
-    md5(&studio->tic->cart, sizeof(tic_cartridge), hash.data);
+    md5(studio->tic->cart, sizeof(tic_cartridge), hash.data);
 
     return memcmp(hash.data, studio->cart.hash.data, sizeof(CartHash)) != 0;
 }
@@ -1895,7 +1924,7 @@ static bool showGameMenu(Studio* studio)
     char tag[TICNAME_MAX];
     snprintf(tag, sizeof tag, "\n%s menu:", tic_get_script(tic)->singleComment);
 
-    return strstr(tic->cart.code.data, tag);
+    return strstr(tic->cart->code.data, tag);
 }
 
 #endif
@@ -2145,6 +2174,12 @@ static void recordFrame(Studio* studio, u32* pixels)
 
 #endif
 
+// netplay frames can be played several times, the run screen starts and ends them
+static inline bool netplayFrame(Studio* studio)
+{
+    return studio->mode == TIC_RUN_MODE && studio->run->netplay.peers;
+}
+
 static void renderStudio(Studio* studio)
 {
     tic_mem* tic = studio->tic;
@@ -2183,7 +2218,8 @@ static void renderStudio(Studio* studio)
         // restore mapping
         studio->tic->ram->mapping = getConfig(studio)->options.mapping;
 
-        tic_core_tick_start(tic);
+        if(!netplayFrame(studio))
+            tic_core_tick_start(tic);
     }
 
     // SECURITY: It's important that this comes before `tick` and not after
@@ -2247,7 +2283,8 @@ static void renderStudio(Studio* studio)
     default: break;
     }
 
-    tic_core_tick_end(tic);
+    if(!netplayFrame(studio))
+        tic_core_tick_end(tic);
 
     switch(studio->mode)
     {
@@ -2449,7 +2486,7 @@ static void blitCursor(Studio* studio)
     if(tic->input.mouse && !m->relative && (s32)m->x < TIC80_FULLWIDTH && (s32)m->y < TIC80_FULLHEIGHT)
     {
         s32 sprite = CLAMP(tic->ram->vram.vars.cursor.sprite, 0, TIC_BANK_SPRITES - 1);
-        const tic_bank* bank = &tic->cart.bank0;
+        const tic_bank* bank = &tic->cart->bank0;
 
         tic_point hot = {0};
 
@@ -2492,7 +2529,58 @@ const tic_mem* studio_mem(Studio* studio)
     return getMemory(studio);
 }
 
-void studio_tick(Studio* studio, tic80_input input)
+static void drawOverlayText(Studio* studio, const char* text, s32 sy)
+{
+    tic_mem* tic = studio->tic;
+
+    const tic_font_data* font = &studio->systemFont.regular;
+    s32 width = font->width;
+    s32 sx = TIC80_FULLWIDTH - (s32)strlen(text) * width - 1;
+
+    u32 fg = tic_rgba(&getConfig(studio)->cart->bank0.palette.vbank0.colors[tic_color_white]);
+    u32 bg = tic_rgba(&getConfig(studio)->cart->bank0.palette.vbank0.colors[tic_color_black]);
+
+    for(s32 y = sy - 1; y < sy + font->height; y++)
+        for(s32 x = sx - 1; x < TIC80_FULLWIDTH; x++)
+            tic->product.screen[x + y * TIC80_FULLWIDTH] = bg;
+
+    for(const char* c = text; *c; c++, sx += width)
+    {
+        const u8* sym = font->data + *c * BITS_IN_BYTE;
+
+        for(s32 y = 0; y < TIC_SPRITESIZE && y < font->height; y++)
+            for(s32 x = 0; x < TIC_SPRITESIZE && x < width; x++)
+                if(tic_tool_peek1(sym, y * TIC_SPRITESIZE + x))
+                    tic->product.screen[sx + x + (sy + y) * TIC80_FULLWIDTH] = fg;
+    }
+}
+
+static void drawFrameRate(Studio* studio)
+{
+    char text[STUDIO_TEXT_BUFFER_WIDTH];
+    s32 size = snprintf(text, sizeof text, "%i/%i FPS", studio->fps.frames, TIC80_FRAMERATE);
+
+    // the game is slowed down when frameskip can't keep up
+    if(studio->fps.ticks < TIC80_FRAMERATE - 1)
+        snprintf(text + size, sizeof text - size, " %i%%", studio->fps.ticks * 100 / TIC80_FRAMERATE);
+
+    drawOverlayText(studio, text, 1);
+
+    // script heap and the collector time of the last frame
+    if(studio->mode == TIC_RUN_MODE && studio->fps.gc.heap)
+    {
+        snprintf(text, sizeof text, "GC %.1fMS %iK", studio->fps.gc.time, studio->fps.gc.heap / 1024);
+        drawOverlayText(studio, text, 1 + studio->systemFont.regular.height + 1);
+    }
+}
+
+void studio_fps(Studio* studio, s32 frames, s32 ticks)
+{
+    studio->fps.frames = frames;
+    studio->fps.ticks = ticks;
+}
+
+static void studioTick(Studio* studio, tic80_input input, bool hidden)
 {
     tic_mem* tic = studio->tic;
     tic->ram->input = input;
@@ -2540,18 +2628,31 @@ void studio_tick(Studio* studio, tic80_input input)
             tic->ram->font = studio->systemFont;
         }
 
-        callback[studio->mode].data
-            ? tic_core_blit_ex(tic, callback[studio->mode])
-            : tic_core_blit(tic);
+#if defined(BUILD_EDITORS)
+        // every frame goes to the gif
+        if(isRecordFrame(studio))
+            hidden = false;
+#endif
 
-        blitCursor(studio);
+        if(hidden && studio->mode == TIC_RUN_MODE)
+            tic_core_blit_skip(tic);
+        else
+        {
+            callback[studio->mode].data
+                ? tic_core_blit_ex(tic, callback[studio->mode])
+                : tic_core_blit(tic);
+
+            blitCursor(studio);
 
 #if defined(BUILD_EDITORS)
-        if(isRecordFrame(studio))
-            recordFrame(studio, tic->product.screen);
+            if(isRecordFrame(studio))
+                recordFrame(studio, tic->product.screen);
 
-        drawPopup(studio);
+            drawPopup(studio);
 #endif
+            if(getConfig(studio)->options.fps)
+                drawFrameRate(studio);
+        }
     }
 
 #if defined(BUILD_SURF)
@@ -2592,6 +2693,23 @@ void studio_tick(Studio* studio, tic80_input input)
 #endif
 }
 
+void studio_tick(Studio* studio, tic80_input input)
+{
+    studioTick(studio, input, false);
+}
+
+void studio_tick_hidden(Studio* studio, tic80_input input)
+{
+    studioTick(studio, input, true);
+}
+
+tic_gc_stats studio_gc(Studio* studio, double budget)
+{
+    return studio->fps.gc = studio->mode == TIC_RUN_MODE
+        ? tic_core_gc(studio->tic, budget)
+        : (tic_gc_stats){0};
+}
+
 void studio_sound(Studio* studio)
 {
     tic_mem* tic = studio->tic;
@@ -2675,6 +2793,8 @@ void studio_delete(Studio* studio)
         FREE(studio->anim.show.items);
         FREE(studio->anim.hide.items);
 
+        tic_cart_sizer_close(studio->sizer);
+
 #endif
 #if defined(BUILD_SURF)
         freeSurf    (studio->surf);
@@ -2700,7 +2820,7 @@ void studio_delete(Studio* studio)
     if(studio->bytebattle.imp) free(studio->bytebattle.imp);
 #endif
 
-    free(studio->fs);
+    tic_fs_close(studio->fs);
     free(studio);
 }
 
@@ -2721,6 +2841,7 @@ static StartArgs parseArgs(s32 argc, char **argv)
 
     StartArgs args = {0};
     args.volume = -1;
+    args.rewind = -1;
 
 #if defined(BUILD_EDITORS)
     args.lowerlimit = 256;
@@ -2837,6 +2958,14 @@ Studio* studio_create(s32 argc, char **argv, s32 samplerate, tic80_pixel_color_f
     fs_enum(fs_appfolder(), onEnumModule, NULL);
 #endif
 
+    // instances on different threads can share carts
+    {
+        static void* lock = NULL;
+
+        if(!lock && (lock = tic_sys_sem_create(1)))
+            tic_core_cart_lock(lock, tic_sys_sem_wait, tic_sys_sem_post);
+    }
+
     Studio* studio = NEW(Studio);
     *studio = (Studio)
     {
@@ -2882,6 +3011,7 @@ Studio* studio_create(s32 argc, char **argv, s32 samplerate, tic80_pixel_color_f
 #endif
 #if defined(BUILD_EDITORS)
         .bytebattle = {0},
+        .sizer = tic_cart_sizer_create(),
 #endif
         .tic = tic_core_create(samplerate, format),
     };
@@ -2950,6 +3080,26 @@ Studio* studio_create(s32 argc, char **argv, s32 samplerate, tic80_pixel_color_f
     studio->mainmenu = NULL;
     tic_fs_makedir(studio->fs, TIC_LOCAL);
     tic_fs_makedir(studio->fs, TIC_LOCAL_VERSION);
+    tic_fs_makedir(studio->fs, TIC_CACHE);
+
+    if(args.cachesize > 0)
+        tic_fs_cachesize(studio->fs, MIN(args.cachesize, 1024) * 1024 * 1024);
+
+    if(args.mirror)
+        tic_fs_mirror(studio->fs, args.mirror);
+
+    if(args.rewind != 0)
+        studio->run->rewind = tic_rewind_create(args.rewind > 0
+            ? MIN(args.rewind, 1024) * 1024 * 1024
+            : TIC_REWIND_SIZE, TIC_REWIND_KEYFRAMES);
+
+    studio->run->record = args.record;
+
+#if defined(TIC80_NETPLAY_UDP)
+    studio->run->netplay.peers = args.netplay;
+    studio->run->netplay.player = MAX(args.player, 1) - 1;
+    studio->run->netplay.delay = args.netdelay > 0 ? args.netdelay : TIC_NETPLAY_DELAY;
+#endif
 
     initConfig(studio->config, studio, studio->fs);
 
@@ -2985,6 +3135,7 @@ Studio* studio_create(s32 argc, char **argv, s32 samplerate, tic80_pixel_color_f
     studio->config->data.options.fullscreen |= args.fullscreen;
     studio->config->data.options.vsync      |= args.vsync;
     studio->config->data.soft               |= args.soft;
+    studio->config->data.threaded           |= args.threaded;
     studio->config->data.cli                |= args.cli;
 
 #if defined(BUILD_EDITORS)
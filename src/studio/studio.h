@@ -50,6 +50,17 @@
 #define TIC_LOCAL_VERSION TIC_LOCAL TIC_VERSION_HASH "/"
 #define TIC_CACHE TIC_LOCAL "cache/"
 
+#if !defined(TIC_CACHE_SIZE)
+#define TIC_CACHE_SIZE (64 * 1024 * 1024)
+#endif
+
+#if !defined(TIC_REWIND_SIZE)
+#define TIC_REWIND_SIZE (32 * 1024 * 1024)
+#endif
+#define TIC_REWIND_KEYFRAMES 60
+#define TIC_NETPLAY_DELAY 2
+#define TIC_FRAMESKIP_MAX 4
+
 #define TOOLBAR_SIZE 7
 #define STUDIO_TEXT_WIDTH (TIC_FONT_WIDTH)
 #define STUDIO_TEXT_HEIGHT (TIC_FONT_HEIGHT+1)
@@ -73,6 +84,15 @@
 #   define CRT_CMD_PARAM(macro)
 #endif
 
+#if defined(TIC80_NETPLAY_UDP)
+#   define NETPLAY_CMD_PARAM(macro)                                                                         \
+    macro(netplay,      char*,  STRING,     "=<str>",   "play over the network, host:port of every player") \
+    macro(player,       s32,    INTEGER,    "=<int>",   "local netplay player [1-4]")                       \
+    macro(netdelay,     s32,    INTEGER,    "=<int>",   "netplay input delay in frames")
+#else
+#   define NETPLAY_CMD_PARAM(macro)
+#endif
+
 #define CMD_PARAMS_LIST(macro)                                                              \
     macro(skip,         int,    BOOLEAN,    "",         "skip startup animation")           \
     macro(volume,       s32,    INTEGER,    "=<int>",   "global volume value [0-15]")       \
@@ -80,12 +100,18 @@
     macro(fullscreen,   int,    BOOLEAN,    "",         "enable fullscreen mode")           \
     macro(vsync,        int,    BOOLEAN,    "",         "enable VSYNC")                     \
     macro(soft,         int,    BOOLEAN,    "",         "use software rendering")           \
+    macro(threaded,     int,    BOOLEAN,    "",         "run the cart and the renderer on separate threads") \
     macro(fs,           char*,  STRING,     "=<str>",   "path to the file system folder")   \
     macro(scale,        s32,    INTEGER,    "=<int>",   "main window scale")                \
     macro(cmd,          char*,  STRING,     "=<str>",   "run commands in the console")      \
     macro(keepcmd,      int,    BOOLEAN,    "",         "re-execute commands on every run") \
     macro(version,      int,    BOOLEAN,    "",         "print program version")            \
-    CRT_CMD_PARAM(macro)
+    macro(cachesize,    s32,    INTEGER,    "=<int>",   "download cache size in MB")        \
+    macro(mirror,       char*,  STRING,     "=<str>",   "local folder to use as the website") \
+    macro(rewind,       s32,    INTEGER,    "=<int>",   "gameplay rewind buffer size in MB, 0 turns it off") \
+    macro(record,       char*,  STRING,     "=<str>",   "record the game session to a replay file") \
+    CRT_CMD_PARAM(macro)                                                                    \
+    NETPLAY_CMD_PARAM(macro)
 
 #define SHOW_TOOLTIP(STUDIO, FORMAT, ...)   \
 do{                                         \
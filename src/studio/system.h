@@ -68,6 +68,14 @@ bool    tic_sys_keyboard_text(char* text);
 void    tic_sys_update_config();
 void    tic_sys_default_mapping(tic_mapping* mapping);
 
+// thread is NULL if the platform can't run one, the work has to be done inline then
+void*   tic_sys_thread_create(s32(*func)(void*), void* data);
+void    tic_sys_thread_join(void* thread);
+void*   tic_sys_sem_create(s32 value);
+void    tic_sys_sem_wait(void* sem);
+void    tic_sys_sem_post(void* sem);
+void    tic_sys_sem_free(void* sem);
+
 #define CODE_COLORS_LIST(macro) \
     macro(BG)       \
     macro(FG)       \
@@ -124,6 +132,7 @@ typedef struct
     bool checkNewVersion;
     bool cli;
     bool soft;
+    bool threaded;
     bool trim;
 
     struct StudioOptions
@@ -134,6 +143,8 @@ typedef struct
 
         bool fullscreen;
         bool vsync;
+        s32 frameskip;
+        bool fps;
         bool integerScale;
         s32 volume;
         bool autosave;
@@ -162,7 +173,10 @@ void setJustSwitchedToCodeMode(Studio* studio, bool value);
 bool hasJustSwitchedToCodeMode(Studio* studio);
 const tic_mem* studio_mem(Studio* studio);
 void studio_tick(Studio* studio, tic80_input input);
+void studio_tick_hidden(Studio* studio, tic80_input input);
+void studio_fps(Studio* studio, s32 frames, s32 ticks);
 void studio_sound(Studio* studio);
+tic_gc_stats studio_gc(Studio* studio, double budget);
 void studio_load(Studio* studio, const char* file);
 void studio_keymapchanged(Studio *studio, tic_layout keyboardLayout);
 bool studio_alive(Studio* studio);
@@ -192,6 +192,57 @@ struct retro_core_option_definition option_defs_us[] = {
       },
       "15"
    },
+   {
+      "tic80_frameskip",
+      "Frameskip",
+      "Skip drawing frames to avoid audio crackling when the device is too slow. 'Auto' skips when the frontend reports that the audio buffer is about to run dry. 'Manual' uses the threshold below. Needs a frontend that reports its audio buffer.",
+      {
+         { "disabled", NULL },
+         { "auto",     "Auto" },
+         { "manual",   "Manual" },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "tic80_frameskip_threshold",
+      "Frameskip Threshold (%)",
+      "When 'Frameskip' is 'Manual', frames are skipped while the audio buffer is less full than this.",
+      {
+         { "15", NULL },
+         { "18", NULL },
+         { "21", NULL },
+         { "24", NULL },
+         { "27", NULL },
+         { "30", NULL },
+         { "33", NULL },
+         { "36", NULL },
+         { "39", NULL },
+         { "42", NULL },
+         { "45", NULL },
+         { "48", NULL },
+         { "51", NULL },
+         { "54", NULL },
+         { "57", NULL },
+         { "60", NULL },
+         { NULL, NULL },
+      },
+      "33"
+   },
+   {
+      "tic80_runahead",
+      "Run-Ahead",
+      "Show the game this many frames ahead to reduce input lag. Needs a cart runtime with save states, and each frame costs as much extra emulation.",
+      {
+         { "disabled", NULL },
+         { "1", NULL },
+         { "2", NULL },
+         { "3", NULL },
+         { "4", NULL },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
    { NULL, NULL, NULL, {{0}}, NULL },
 };
 
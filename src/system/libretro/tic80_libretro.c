@@ -4,6 +4,7 @@
 #include <stdarg.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
 #include "tic.h"
 #include "libretro-common/include/libretro.h"
 #include "retro_inline.h"
@@ -56,6 +57,12 @@ enum mouse_cursor_type
 	MOUSE_CURSOR_ARROW
 };
 
+enum frameskip_type {
+	FRAMESKIP_DISABLED,
+	FRAMESKIP_AUTO,
+	FRAMESKIP_MANUAL,
+};
+
 struct tic80_state
 {
 	bool quit;
@@ -78,6 +85,37 @@ struct tic80_state
 	int mouseHideTimerStart;
 	tic80* tic;
 	retro_usec_t frameTime;
+	tic80_clock clock;
+	struct
+	{
+		bool canDupe;
+		bool changed;
+		struct cursor_key { s32 x; s32 y; enum mouse_cursor_type type; u32 color; bool visible; } cursor;
+		struct { u32* ptr; u32 color; } under[64];
+		int underCount;
+	} video;
+	struct
+	{
+		enum frameskip_type type;
+		int threshold;
+		int skipped;
+		bool skip;
+		bool active;
+		unsigned occupancy;
+		bool underrun;
+		unsigned latency;
+		bool latencyChanged;
+	} frameskip;
+	struct
+	{
+		int frames;
+		void* buffer;
+		s32 size;
+		bool unsupported;
+		bool active;
+		clock_t cost;
+		int count;
+	} runAhead;
 };
 static struct tic80_state* state = NULL;
 
@@ -106,7 +144,7 @@ static u64 tic80_libretro_frequency()
  */
 void tic80_libretro_exit()
 {
-	if (state == NULL) {
+	if (state == NULL || state->runAhead.active) {
 		return;
 	}
 
@@ -118,6 +156,10 @@ void tic80_libretro_exit()
  */
 void tic80_libretro_error(const char* info)
 {
+	if (state != NULL && state->runAhead.active) {
+		return;
+	}
+
 	// Report the error to the log.
 	log_cb(RETRO_LOG_ERROR, "[TIC-80]: %s\n", info);
 
@@ -140,6 +182,9 @@ void tic80_libretro_error(const char* info)
 void tic80_libretro_trace(const char* text, u8 color)
 {
 	TIC_UNUSED(color);
+	if (state != NULL && state->runAhead.active) {
+		return;
+	}
 	log_cb(RETRO_LOG_DEBUG, "[TIC-80] %s\n", text);
 }
 
@@ -166,6 +211,81 @@ void tic80_libretro_frame_time(retro_usec_t usec) {
 	state->frameTime += usec;
 }
 
+/**
+ * libretro callback; Reports how full the frontend audio buffer is.
+ */
+static void tic80_libretro_audio_buffer_status(bool active, unsigned occupancy, bool underrun_likely)
+{
+	if (state == NULL) {
+		return;
+	}
+
+	state->frameskip.active = active;
+	state->frameskip.occupancy = occupancy;
+	state->frameskip.underrun = underrun_likely;
+}
+
+/**
+ * Ask for the audio buffer status when frames can be skipped.
+ */
+static void tic80_libretro_frameskip_setup()
+{
+	struct retro_audio_buffer_status_callback callback = {
+		.callback = tic80_libretro_audio_buffer_status,
+	};
+	bool enabled = state->frameskip.type != FRAMESKIP_DISABLED
+		&& environ_cb(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK, &callback);
+
+	if (!enabled) {
+		environ_cb(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK, NULL);
+		state->frameskip.active = false;
+		if (state->frameskip.type != FRAMESKIP_DISABLED) {
+			log_cb(RETRO_LOG_WARN, "[TIC-80] Frameskip needs the audio buffer status from the frontend.\n");
+		}
+	}
+
+	// A few frames of audio latency leave room to catch up, it's handed over in retro_run().
+	unsigned latency = enabled ? 6 * 1000 / TIC80_FRAMERATE : 0;
+	if (latency != state->frameskip.latency) {
+		state->frameskip.latency = latency;
+		state->frameskip.latencyChanged = true;
+	}
+}
+
+/**
+ * Decide if the next frame is only emulated and not rendered, as the audio is about to run dry.
+ *
+ * @see retro_run()
+ */
+static void tic80_libretro_frameskip()
+{
+	bool skip = false;
+
+	if (state->frameskip.active) {
+		switch (state->frameskip.type) {
+			case FRAMESKIP_AUTO:
+				skip = state->frameskip.underrun;
+				break;
+			case FRAMESKIP_MANUAL:
+				skip = state->frameskip.occupancy < (unsigned)state->frameskip.threshold;
+				break;
+			default:
+				break;
+		}
+	}
+
+	// Show something at least twice a second.
+	if (skip && state->frameskip.skipped < TIC80_FRAMERATE / 2) {
+		state->frameskip.skipped++;
+	}
+	else {
+		skip = false;
+		state->frameskip.skipped = 0;
+	}
+
+	state->frameskip.skip = skip;
+}
+
 /**
  * libretro callback; Global initialization.
  */
@@ -786,8 +906,17 @@ static void draw_pixel_on_screen(u32* screen, s32 x, s32 y, u32 color)
 
 	s32 full_x = x + TIC80_OFFSET_LEFT;
 	s32 full_y = y + TIC80_OFFSET_TOP;
+	u32* pixel = &screen[full_y * TIC80_FULLWIDTH + full_x];
+
+	// Keep the frame under the cursor, so it can be put back after the upload.
+	if (state->video.underCount == COUNT_OF(state->video.under)) {
+		return;
+	}
+	state->video.under[state->video.underCount].ptr = pixel;
+	state->video.under[state->video.underCount].color = *pixel;
+	state->video.underCount++;
 
-	screen[full_y * TIC80_FULLWIDTH + full_x] = color;
+	*pixel = color;
 }
 
 /**
@@ -808,8 +937,21 @@ static void draw_vline_on_screen(u32* screen, s32 x, s32 y1, s32 y2, u32 color)
 		draw_pixel_on_screen(screen, x, y, color);
 }
 
+/**
+ * Removes the software cursor from the emulator framebuffer.
+ */
+static void tic80_libretro_mousecursor_clear()
+{
+	while (state->video.underCount > 0) {
+		state->video.underCount--;
+		*state->video.under[state->video.underCount].ptr = state->video.under[state->video.underCount].color;
+	}
+}
+
 /**
  * Draws a software cursor on the screen where the mouse is.
+ *
+ * It's an overlay, call tic80_libretro_mousecursor_clear() once the frame is uploaded.
  */
 void tic80_libretro_mousecursor(tic80* game, tic80_mouse* mouse, enum mouse_cursor_type cursortype)
 {
@@ -913,26 +1055,118 @@ void tic80_libretro_update(tic80* game)
 	// Keyboard
 	tic80_libretro_update_keyboard(&state->input.keyboard);
 
-	// Update the game state.
-	tic80_tick(game, state->input, tic80_libretro_counter, tic80_libretro_frequency);
+	// Update the game state, the screen is only drawn when the frame changed and isn't skipped.
+	// Cart time follows the frames, so run-ahead, rewind, fast-forward and frameskip see the same clock.
+	if (state->frameskip.skip) {
+		tic80_tick_hidden(game, state->input, tic80_libretro_counter, tic80_libretro_frequency, &state->clock);
+	}
+	else {
+		state->video.changed |= tic80_tick_cached(game, state->input, tic80_libretro_counter, tic80_libretro_frequency, &state->clock);
+	}
 	tic80_sound(game);
 }
 
+/**
+ * Run the game ahead with the same input and show that future frame, then go back.
+ *
+ * The hidden frames are neither drawn nor heard, and their callbacks are muted,
+ * they run again for real on the next frames.
+ *
+ * @see retro_run()
+ */
+void tic80_libretro_runahead(tic80* game)
+{
+	if (state->runAhead.frames == 0 || state->runAhead.unsupported) {
+		return;
+	}
+
+	s32 size = tic80_state_size(game);
+	if (size <= 0) {
+		log_cb(RETRO_LOG_WARN, "[TIC-80] Run-ahead is not supported by the runtime of this cart.\n");
+		state->runAhead.unsupported = true;
+		return;
+	}
+
+	// The state size is fixed for the cart, so the buffer is only grown on a new cart.
+	if (size > state->runAhead.size) {
+		void* buffer = realloc(state->runAhead.buffer, size);
+		if (buffer == NULL) {
+			return;
+		}
+		state->runAhead.buffer = buffer;
+		state->runAhead.size = size;
+	}
+
+	clock_t start = clock();
+	if (!tic80_state_save(game, state->runAhead.buffer, size)) {
+		return;
+	}
+
+	state->runAhead.active = true;
+	for (int i = 0; i < state->runAhead.frames; i++) {
+		if (i == state->runAhead.frames - 1) {
+			tic80_tick_clock(game, state->input, tic80_libretro_counter, tic80_libretro_frequency, &state->clock);
+		}
+		else {
+			tic80_tick_hidden(game, state->input, tic80_libretro_counter, tic80_libretro_frequency, &state->clock);
+		}
+	}
+
+	state->runAhead.active = false;
+	state->video.changed = true;
+	if (!tic80_state_load(game, state->runAhead.buffer, size)) {
+		// The machine is left in the future, don't run ahead of it again.
+		log_cb(RETRO_LOG_ERROR, "[TIC-80] Could not restore the state after running ahead, run-ahead is off.\n");
+		state->runAhead.unsupported = true;
+		return;
+	}
+
+	// Report the average cost every ten seconds.
+	state->runAhead.cost += clock() - start;
+	if (++state->runAhead.count == 10 * TIC80_FRAMERATE) {
+		log_cb(RETRO_LOG_INFO, "[TIC-80] Run-ahead of %d frames costs %.2f ms per frame.\n", state->runAhead.frames,
+			(double)state->runAhead.cost * 1000.0 / CLOCKS_PER_SEC / state->runAhead.count);
+		state->runAhead.cost = 0;
+		state->runAhead.count = 0;
+	}
+}
+
 /**
  * Draw the screen.
  */
 void tic80_libretro_draw(tic80* game)
 {
+	// The same frame with the same cursor is a dupe, the frontend shows the last one again.
+	struct cursor_key cursor = {
+		.x = state->mouseX,
+		.y = state->mouseY,
+		.type = state->mouseCursor,
+		.color = get_screen_color((tic_mem*)game, state->mouseCursorColor),
+		.visible = state->mouseHideTimerStart == 0 || state->mouseHideTimer > 0,
+	};
+	bool dupe = state->video.canDupe && !state->video.changed
+		&& memcmp(&cursor, &state->video.cursor, sizeof cursor) == 0;
+	state->video.cursor = cursor;
+	state->video.changed = false;
+
+	unsigned width = state->cropBorder ? TIC80_WIDTH : TIC80_FULLWIDTH;
+	unsigned height = state->cropBorder ? TIC80_HEIGHT : TIC80_FULLHEIGHT;
+
+	if (dupe) {
+		video_cb(NULL, width, height, TIC80_FULLWIDTH << 2);
+		return;
+	}
+
 	// Render the mouse cursor if needed.
 	tic80_libretro_mousecursor((tic80*)game, &state->input.mouse, state->mouseCursor);
 
-	// Render to the screen.
-	if (state->cropBorder) {
-		u32 *screen = (u32*)game->screen + (TIC80_FULLWIDTH * TIC80_OFFSET_TOP) + TIC80_OFFSET_LEFT;
-		video_cb(screen, TIC80_WIDTH, TIC80_HEIGHT, TIC80_FULLWIDTH << 2);
-	} else {
-		video_cb(game->screen, TIC80_FULLWIDTH, TIC80_FULLHEIGHT, TIC80_FULLWIDTH << 2);
-	}
+	// The cropped frame is the same buffer with the full pitch.
+	u32 *screen = state->cropBorder
+		? (u32*)game->screen + (TIC80_FULLWIDTH * TIC80_OFFSET_TOP) + TIC80_OFFSET_LEFT
+		: (u32*)game->screen;
+	video_cb(screen, width, height, TIC80_FULLWIDTH << 2);
+
+	tic80_libretro_mousecursor_clear();
 }
 
 /**
@@ -968,6 +1202,7 @@ void tic80_libretro_variables(bool startup)
 	}
 
 	if (!startup && (state->cropBorder != lastCropBorder)) {
+		state->video.changed = true;
 		struct retro_system_av_info av_info;
 		retro_get_system_av_info(&av_info);
 		environ_cb(RETRO_ENVIRONMENT_SET_GEOMETRY, &av_info);
@@ -1042,6 +1277,40 @@ void tic80_libretro_variables(bool startup)
 		}
 	}
 
+	// Run-Ahead
+	state->runAhead.frames = 0;
+	var.key = "tic80_runahead";
+	var.value = NULL;
+	if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value) {
+		state->runAhead.frames = atoi(var.value);
+	}
+
+	// Frameskip
+	enum frameskip_type lastFrameskip = state->frameskip.type;
+	state->frameskip.type = FRAMESKIP_DISABLED;
+	var.key = "tic80_frameskip";
+	var.value = NULL;
+	if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value) {
+		if (strcmp(var.value, "auto") == 0) {
+			state->frameskip.type = FRAMESKIP_AUTO;
+		}
+		else if (strcmp(var.value, "manual") == 0) {
+			state->frameskip.type = FRAMESKIP_MANUAL;
+		}
+	}
+
+	if (startup || state->frameskip.type != lastFrameskip) {
+		tic80_libretro_frameskip_setup();
+	}
+
+	// Frameskip Threshold
+	state->frameskip.threshold = 33;
+	var.key = "tic80_frameskip_threshold";
+	var.value = NULL;
+	if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value) {
+		state->frameskip.threshold = atoi(var.value);
+	}
+
 	// Gamepad Analog Deadzone
 	state->analogDeadzone = (int)(0.15f * (float)RETRO_ANALOG_RANGE);
 	var.key = "tic80_analog_deadzone";
@@ -1061,6 +1330,15 @@ RETRO_API void retro_run(void)
 		return;
 	}
 
+	// The frontend only takes the audio latency from within retro_run().
+	if (state->frameskip.latencyChanged) {
+		environ_cb(RETRO_ENVIRONMENT_SET_MINIMUM_AUDIO_LATENCY, &state->frameskip.latency);
+		state->frameskip.latencyChanged = false;
+	}
+
+	// Skip the render if the audio is falling behind.
+	tic80_libretro_frameskip();
+
 	// Update the TIC-80 environment.
 	tic80_libretro_update(state->tic);
 
@@ -1071,7 +1349,12 @@ RETRO_API void retro_run(void)
 		return;
 	}
 
-	// Render the screen.
+	// Show a frame from the future, if asked to.
+	if (!state->frameskip.skip) {
+		tic80_libretro_runahead(state->tic);
+	}
+
+	// Render the screen, a skipped frame leaves the last one.
 	tic80_libretro_draw(state->tic);
 
 	// Play the audio.
@@ -1090,7 +1373,6 @@ RETRO_API void retro_run(void)
 RETRO_API bool retro_load_game(const struct retro_game_info *info)
 {
 	// TODO: Warn that Audio Synchronization required to run at a proper speed.
-	// TODO: Warn that the core doesn't support Runahead.
 
 	// Initialize the core if it hasn't been yet.
 	if (state == NULL) {
@@ -1116,6 +1398,10 @@ RETRO_API bool retro_load_game(const struct retro_game_info *info)
 		return false;
 	}
 
+	// Unchanged frames are passed as dupes if the frontend allows it.
+	state->video.canDupe = false;
+	environ_cb(RETRO_ENVIRONMENT_GET_CAN_DUPE, &state->video.canDupe);
+
 	// Set up the frame time callback.
 	struct retro_frame_time_callback frame_time = {
 		.callback = tic80_libretro_frame_time,
@@ -1146,6 +1432,7 @@ RETRO_API bool retro_load_game(const struct retro_game_info *info)
 	state->quit = false;
 	state->input.mouse.x = 0;
 	state->input.mouse.y = 0;
+	state->clock = (tic80_clock){.mode = TIC80_CLOCK_FRAMES, .tstamp = (s32)time(NULL)};
 
 	// Load the content.
 	// TODO: Allow loading code files directly.
@@ -1176,6 +1463,9 @@ RETRO_API void retro_unload_game(void)
 
 	tic80_delete(state->tic);
 	state->tic = NULL;
+
+	free(state->runAhead.buffer);
+	memset(&state->runAhead, 0, sizeof state->runAhead);
 }
 
 /**
@@ -1199,22 +1489,37 @@ RETRO_API bool retro_load_game_special(unsigned type, const struct retro_game_in
 
 /**
  * libretro callback; Retrieve the size of the serialized memory.
+ *
+ * The full machine state when the runtime can save it, the persistent memory otherwise.
  */
 size_t retro_serialize_size(void)
 {
+	if (state != NULL && state->tic != NULL) {
+		s32 size = tic80_state_size(state->tic);
+		if (size > 0) {
+			return size;
+		}
+	}
+
 	return TIC_PERSISTENT_SIZE * sizeof(u32);
 }
 
 /**
- * libretro callback; Get the current persistent memory.
+ * libretro callback; Get the current machine state or persistent memory.
  */
 RETRO_API bool retro_serialize(void *data, size_t size)
 {
-	TIC_UNUSED(size);
 	if (state == NULL || state->tic == NULL || data == NULL) {
 		return false;
 	}
 
+	if (tic80_state_size(state->tic) > 0) {
+		// the frontend compares states by size, so the unused tail is zeroed here
+		// and not by the core where run-ahead and rewind save every frame
+		memset(data, 0, size);
+		return tic80_state_save(state->tic, data, size);
+	}
+
 	tic_mem* tic = (tic_mem*)state->tic;
 	u32* udata = (u32*)data;
 	for (u32 i = 0; i < TIC_PERSISTENT_SIZE; i++) {
@@ -1225,14 +1530,18 @@ RETRO_API bool retro_serialize(void *data, size_t size)
 }
 
 /**
- * libretro callback; Given the serialized data, load it into the persistent memory.
+ * libretro callback; Given the serialized data, load it into the machine state or persistent memory.
  */
 RETRO_API bool retro_unserialize(const void *data, size_t size)
 {
-	if (state == NULL || state->tic == NULL || size != retro_serialize_size() || data == NULL) {
+	if (state == NULL || state->tic == NULL || data == NULL) {
 		return false;
 	}
 
+	if (size != TIC_PERSISTENT_SIZE * sizeof(u32)) {
+		return tic80_state_load(state->tic, data, size);
+	}
+
 	tic_mem* tic = (tic_mem*)state->tic;
 	u32* uData = (u32*)data;
 	for (u32 i = 0; i < TIC_PERSISTENT_SIZE; i++) {
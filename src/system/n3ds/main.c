@@ -216,6 +216,14 @@ void tic_sys_preseed()
     rand();
 }
 
+// no worker threads here, callers do the work inline
+void* tic_sys_thread_create(s32(*func)(void*), void* data) {return NULL;}
+void tic_sys_thread_join(void* thread) {}
+void* tic_sys_sem_create(s32 value) {return NULL;}
+void tic_sys_sem_wait(void* sem) {}
+void tic_sys_sem_post(void* sem) {}
+void tic_sys_sem_free(void* sem) {}
+
 void tic_sys_update_config()
 {
 
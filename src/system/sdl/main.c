@@ -196,6 +196,80 @@ static struct
       SDL_AudioSpec       spec;
       SDL_AudioDeviceID   device;
     } audioIn;
+
+    struct
+    {
+        u64 start;
+        s32 frames;
+        s32 ticks;
+    } fps;
+
+#if !defined(__EMSCRIPTEN__)
+    struct
+    {
+        SDL_Thread* handle;
+        SDL_threadID id;    // set by the thread itself, the handle comes later
+        SDL_mutex*  lock;
+        SDL_sem*    ready;
+
+        // written by the render thread, taken by the emulation thread
+        struct
+        {
+            tic80_input input;
+            char text;
+            bool taken;
+
+            char title[TICNAME_MAX];
+            bool retitle;
+
+            bool fullscreen;
+            bool refullscreen;
+            // the window state as the render thread saw it last
+            bool isfullscreen;
+
+            // message boxes have to be shown from the main thread
+            char* message;
+            char* messageTitle;
+
+            // text the studio copied, the render thread puts it to the clipboard
+            char* copy;
+            // the clipboard as the render thread saw it last
+            char* clipboard;
+
+            bool reconfig;
+
+            tic_layout keymap;
+            bool rekeymap;
+
+            char* load;
+            bool quit;
+        } shared;
+
+        // text input of the current emulation tick
+        char text;
+
+        // lock-free triple buffer: the emulation thread draws into 'back',
+        // the render thread presents 'front', they swap through 'middle'
+        u32 frames[3][TIC80_FULLWIDTH * TIC80_FULLHEIGHT];
+        u32 seq[3];
+        // the RAM input of each frame, the render thread can't read the RAM
+        // because it's reallocated by the emulation thread
+        tic80_input inputs[3];
+        SDL_atomic_t middle;
+        s32 back;
+        s32 front;
+        u32 produced;
+
+        struct
+        {
+            u64 start;
+            u32 last;
+            s32 presented;
+            s32 dropped;
+            s32 depth;
+        } stats;
+    } thread;
+#endif
 } platform
 #if defined(TOUCH_INPUT_SUPPORT)
 =
@@ -1115,13 +1189,101 @@ tic_layout detect_keyboard_layout()
     return layout;
 }
 
+static void studioLoad(const char* file)
+{
+#if !defined(__EMSCRIPTEN__)
+    // the studio belongs to the emulation thread
+    if(platform.thread.handle)
+    {
+        LOCK_MUTEX(platform.thread.lock)
+        {
+            free(platform.thread.shared.load);
+            platform.thread.shared.load = strdup(file);
+        }
+
+        return;
+    }
+#endif
+
+    studio_load(platform.studio, file);
+}
+
+static void studioKeymapChanged()
+{
+    tic_layout layout = detect_keyboard_layout();
+
+#if !defined(__EMSCRIPTEN__)
+    if(platform.thread.handle)
+    {
+        LOCK_MUTEX(platform.thread.lock)
+        {
+            platform.thread.shared.keymap = layout;
+            platform.thread.shared.rekeymap = true;
+        }
+
+        return;
+    }
+#endif
+
+    studio_keymapchanged(platform.studio, layout);
+}
+
+// the input of the frame on the screen
+static const tic80_input* screenInput()
+{
+#if !defined(__EMSCRIPTEN__)
+    if(platform.thread.handle)
+        return &platform.thread.inputs[platform.thread.front];
+#endif
+
+    return &studio_mem(platform.studio)->ram->input;
+}
+
+#if !defined(__EMSCRIPTEN__)
+// render thread: keep a copy of the clipboard for the emulation thread
+static void updateClipboard()
+{
+    char* text = SDL_HasClipboardText() ? SDL_GetClipboardText() : NULL;
+
+    LOCK_MUTEX(platform.thread.lock)
+    {
+        // the copy isn't on the clipboard yet, it'll come with the next update
+        if(!platform.thread.shared.copy)
+        {
+            SDL_free(platform.thread.shared.clipboard);
+            platform.thread.shared.clipboard = text;
+            text = NULL;
+        }
+    }
+
+    SDL_free(text);
+}
+#endif
+
+static void studioExit()
+{
+#if !defined(__EMSCRIPTEN__)
+    if(platform.thread.handle)
+    {
+        LOCK_MUTEX(platform.thread.lock)
+        {
+            platform.thread.shared.quit = true;
+        }
+
+        return;
+    }
+#endif
+
+    studio_exit(platform.studio);
+}
+
 static void pollEvents()
 {
     // check if releative mode was enabled
     {
-        const tic_mem* tic = studio_mem(platform.studio);
-        if((bool)tic->ram->input.mouse.relative != (bool)SDL_GetRelativeMouseMode())
-            SDL_SetRelativeMouseMode(tic->ram->input.mouse.relative ? SDL_TRUE : SDL_FALSE);
+        const tic80_input* input = screenInput();
+        if((bool)input->mouse.relative != (bool)SDL_GetRelativeMouseMode())
+            SDL_SetRelativeMouseMode(input->mouse.relative ? SDL_TRUE : SDL_FALSE);
     }
 
     ZEROMEM(platform.input);
@@ -1246,17 +1408,23 @@ static void pollEvents()
             handleKeydown(event.key.keysym.sym, false, platform.keyboard.state, platform.keyboard.pressed);
             break;
         case SDL_KEYMAPCHANGED:
-            studio_keymapchanged(platform.studio, detect_keyboard_layout());
+            studioKeymapChanged();
             break;
+#if !defined(__EMSCRIPTEN__)
+        case SDL_CLIPBOARDUPDATE:
+            if(platform.thread.handle)
+                updateClipboard();
+            break;
+#endif
         case SDL_TEXTINPUT:
             if(strlen(event.text.text) == 1)
                 platform.keyboard.text = event.text.text[0];
             break;
         case SDL_DROPFILE:
-            studio_load(platform.studio, event.drop.file);
+            studioLoad(event.drop.file);
             break;
         case SDL_QUIT:
-            studio_exit(platform.studio);
+            studioExit();
             break;
         default:
             break;
@@ -1280,6 +1448,16 @@ static void pollEvents()
     processGamepad();
 }
 
+static bool isEmulationThread()
+{
+#if !defined(__EMSCRIPTEN__)
+    return platform.thread.id
+        && SDL_ThreadID() == platform.thread.id;
+#else
+    return false;
+#endif
+}
+
 bool tic_sys_keyboard_text(char* text)
 {
 #if defined(TOUCH_INPUT_SUPPORT)
@@ -1287,6 +1465,14 @@ bool tic_sys_keyboard_text(char* text)
         return false;
 #endif
 
+#if !defined(__EMSCRIPTEN__)
+    if(isEmulationThread())
+    {
+        *text = platform.thread.text;
+        return true;
+    }
+#endif
+
     *text = platform.keyboard.text;
     return true;
 }
@@ -1305,7 +1491,7 @@ static void renderKeyboard()
 
     renderCopy(platform.screen.renderer, platform.keyboard.touch.texture.up, src, dst);
 
-    const tic80_input* input = &studio_mem(platform.studio)->ram->input;
+    const tic80_input* input = screenInput();
 
     enum{Cols=KBD_COLS, Rows=KBD_ROWS};
 
@@ -1350,7 +1536,7 @@ static void renderGamepad()
     const s32 tileSize = platform.gamepad.touch.button.size;
     const SDL_Point axis = platform.gamepad.touch.button.axis;
     typedef struct { bool press; s32 x; s32 y;} Tile;
-    const tic80_input* input = &studio_mem(platform.studio)->ram->input;
+    const tic80_input* input = screenInput();
     const Tile Tiles[] =
     {
         {input->gamepads.first.up,     axis.x + 1*tileSize, axis.y + 0*tileSize},
@@ -1422,18 +1608,63 @@ static const char* getAppFolder()
     return appFolder;
 }
 
+// the clipboard belongs to the render thread, the emulation thread
+// works with the copy the render thread keeps
 void tic_sys_clipboard_set(const char* text)
 {
+#if !defined(__EMSCRIPTEN__)
+    if(isEmulationThread())
+    {
+        LOCK_MUTEX(platform.thread.lock)
+        {
+            SDL_free(platform.thread.shared.copy);
+            SDL_free(platform.thread.shared.clipboard);
+            platform.thread.shared.copy = SDL_strdup(text);
+            platform.thread.shared.clipboard = SDL_strdup(text);
+        }
+
+        return;
+    }
+#endif
+
     SDL_SetClipboardText(text);
 }
 
 bool tic_sys_clipboard_has()
 {
+#if !defined(__EMSCRIPTEN__)
+    if(isEmulationThread())
+    {
+        bool has = false;
+
+        LOCK_MUTEX(platform.thread.lock)
+        {
+            has = platform.thread.shared.clipboard && *platform.thread.shared.clipboard;
+        }
+
+        return has;
+    }
+#endif
+
     return SDL_HasClipboardText();
 }
 
 char* tic_sys_clipboard_get()
 {
+#if !defined(__EMSCRIPTEN__)
+    if(isEmulationThread())
+    {
+        char* text = NULL;
+
+        LOCK_MUTEX(platform.thread.lock)
+        {
+            text = SDL_strdup(platform.thread.shared.clipboard ? platform.thread.shared.clipboard : "");
+        }
+
+        return text;
+    }
+#endif
+
     return SDL_GetClipboardText();
 }
 
@@ -1454,6 +1685,20 @@ u64 tic_sys_freq_get()
 
 bool tic_sys_fullscreen_get()
 {
+#if !defined(__EMSCRIPTEN__)
+    if(isEmulationThread())
+    {
+        bool value = false;
+
+        LOCK_MUTEX(platform.thread.lock)
+        {
+            value = platform.thread.shared.isfullscreen;
+        }
+
+        return value;
+    }
+#endif
+
 #if defined(CRT_SHADER_SUPPORT)
     if(!studio_config(platform.studio)->soft)
     {
@@ -1469,6 +1714,22 @@ bool tic_sys_fullscreen_get()
 
 void tic_sys_fullscreen_set(bool value)
 {
+#if !defined(__EMSCRIPTEN__)
+    // the window belongs to the render thread
+    if(isEmulationThread())
+    {
+        LOCK_MUTEX(platform.thread.lock)
+        {
+            platform.thread.shared.fullscreen = value;
+            platform.thread.shared.refullscreen = true;
+            // seen at once, the window follows on the next render thread pass
+            platform.thread.shared.isfullscreen = value;
+        }
+
+        return;
+    }
+#endif
+
 #if defined(CRT_SHADER_SUPPORT)
     if(!studio_config(platform.studio)->soft)
     {
@@ -1484,11 +1745,41 @@ void tic_sys_fullscreen_set(bool value)
 
 void tic_sys_message(const char* title, const char* message)
 {
+#if !defined(__EMSCRIPTEN__)
+    if(isEmulationThread())
+    {
+        LOCK_MUTEX(platform.thread.lock)
+        {
+            // only the last one is shown if they come faster than the frames
+            SDL_free(platform.thread.shared.message);
+            SDL_free(platform.thread.shared.messageTitle);
+
+            platform.thread.shared.message = SDL_strdup(message);
+            platform.thread.shared.messageTitle = SDL_strdup(title);
+        }
+
+        return;
+    }
+#endif
+
     SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_WARNING, title, message, NULL);
 }
 
 void tic_sys_title(const char* title)
 {
+#if !defined(__EMSCRIPTEN__)
+    if(isEmulationThread())
+    {
+        LOCK_MUTEX(platform.thread.lock)
+        {
+            snprintf(platform.thread.shared.title, sizeof platform.thread.shared.title, "%s", title);
+            platform.thread.shared.retitle = true;
+        }
+
+        return;
+    }
+#endif
+
     if(platform.window)
         SDL_SetWindowTitle(platform.window, title);
 }
@@ -1542,6 +1833,36 @@ void tic_sys_preseed()
 #endif
 }
 
+void* tic_sys_thread_create(s32(*func)(void*), void* data)
+{
+    return SDL_CreateThread((SDL_ThreadFunction)func, "tic80 worker", data);
+}
+
+void tic_sys_thread_join(void* thread)
+{
+    SDL_WaitThread(thread, NULL);
+}
+
+void* tic_sys_sem_create(s32 value)
+{
+    return SDL_CreateSemaphore(value);
+}
+
+void tic_sys_sem_wait(void* sem)
+{
+    SDL_SemWait(sem);
+}
+
+void tic_sys_sem_post(void* sem)
+{
+    SDL_SemPost(sem);
+}
+
+void tic_sys_sem_free(void* sem)
+{
+    SDL_DestroySemaphore(sem);
+}
+
 #if defined(CRT_SHADER_SUPPORT)
 
 static void loadCrtShader()
@@ -1734,6 +2055,19 @@ static void loadCrtShader()
 
 void tic_sys_update_config()
 {
+#if !defined(__EMSCRIPTEN__)
+    // the textures belong to the render thread
+    if(isEmulationThread())
+    {
+        LOCK_MUTEX(platform.thread.lock)
+        {
+            platform.thread.shared.reconfig = true;
+        }
+
+        return;
+    }
+#endif
+
 #if defined(TOUCH_INPUT_SUPPORT)
     if(platform.screen.renderer.sdl)
         initTouchGamepad();
@@ -1769,10 +2103,46 @@ void tic_sys_default_mapping(tic_mapping* mapping)
     }
 }
 
-static void gpuTick()
+static void countFps(bool rendered)
 {
-    const tic_mem* tic = studio_mem(platform.studio);
+    u64 now = SDL_GetPerformanceCounter();
+    u64 freq = SDL_GetPerformanceFrequency();
+
+    if(platform.fps.start == 0)
+        platform.fps.start = now;
+
+    platform.fps.ticks++;
+
+    if(rendered)
+        platform.fps.frames++;
+
+    u64 elapsed = now - platform.fps.start;
+
+    if(elapsed >= freq)
+    {
+        studio_fps(platform.studio,
+            (s32)((platform.fps.frames * freq + elapsed / 2) / elapsed),
+            (s32)((platform.fps.ticks * freq + elapsed / 2) / elapsed));
+
+        platform.fps.start = now;
+        platform.fps.frames = platform.fps.ticks = 0;
+    }
+}
+
+static void emulate(tic80_input input, bool hidden)
+{
+    LOCK_MUTEX(platform.audio.mutex)
+    {
+        hidden
+            ? studio_tick_hidden(platform.studio, input)
+            : studio_tick(platform.studio, input);
+    }
+
+    countFps(!hidden);
+}
 
+static bool studioTick(bool hidden)
+{
     pollEvents();
 
     if(studio_alive(platform.studio))
@@ -1780,16 +2150,22 @@ static void gpuTick()
 #if defined __EMSCRIPTEN__
         emscripten_cancel_main_loop();
 #endif
-        return;
+        return false;
     }
 
-    LOCK_MUTEX(platform.audio.mutex)
-    {
-        studio_tick(platform.studio, platform.input);
-    }
+    emulate(platform.input, hidden);
+
+    platform.keyboard.text = '\0';
+
+    return true;
+}
+
+static void gpuRender(const u32* screen)
+{
+    const tic80_input* input = screenInput();
 
     renderClear(platform.screen.renderer);
-    updateTextureBytes(platform.screen.texture, tic->product.screen, TIC80_FULLWIDTH, TIC80_FULLHEIGHT);
+    updateTextureBytes(platform.screen.texture, screen, TIC80_FULLWIDTH, TIC80_FULLHEIGHT);
 
     SDL_Rect rect;
     calcTextureRect(&rect);
@@ -1820,7 +2196,7 @@ static void gpuTick()
         s32 w, h;
         SDL_GetWindowSize(platform.window, &w, &h);
 
-        s32 offset = tic->ram->input.mouse.x < TIC80_FULLHEIGHT / 2
+        s32 offset = input->mouse.x < TIC80_FULLHEIGHT / 2
             ? TIC80_FULLWIDTH-TIC80_OFFSET_LEFT : 0;
 
         const SDL_Rect Src[] =
@@ -1854,12 +2230,390 @@ static void gpuTick()
 #endif
 
     renderPresent(platform.screen.renderer);
+}
+
+#if !defined(__EMSCRIPTEN__)
+
+typedef struct
+{
+    u64 next;
+    s32 skipped;
+} Scheduler;
+
+static Scheduler schedulerStart()
+{
+    return (Scheduler){SDL_GetPerformanceCounter(), 0};
+}
+
+static bool schedulerSkip(const Scheduler* sched)
+{
+    const u64 Delta = SDL_GetPerformanceFrequency() / TIC80_FRAMERATE;
+
+    // a whole frame behind: run the game but don't draw
+    // the screen, at most 'frameskip' times in a row
+    return sched->skipped < studio_config(platform.studio)->options.frameskip
+        && (s64)(SDL_GetPerformanceCounter() - sched->next) >= (s64)Delta;
+}
+
+static void schedulerWait(Scheduler* sched, bool hidden)
+{
+    const u64 Delta = SDL_GetPerformanceFrequency() / TIC80_FRAMERATE;
+
+    sched->skipped = hidden ? sched->skipped + 1 : 0;
+
+    s64 delay = (sched->next += Delta) - SDL_GetPerformanceCounter();
+
+    if(delay > 0)
+    {
+        // give half of the idle time to the script GC,
+        // so it doesn't kick in in the middle of TIC()
+        studio_gc(platform.studio, delay * 500.0 / SDL_GetPerformanceFrequency());
+        delay = sched->next - SDL_GetPerformanceCounter();
+
+        if(delay > 0)
+            SDL_Delay((u32)(delay * 1000 / SDL_GetPerformanceFrequency()));
+    }
+    // too late to catch up by skipping frames, slow the game down
+    else if(-delay > (s64)Delta * studio_config(platform.studio)->options.frameskip)
+        sched->next = SDL_GetPerformanceCounter();
+}
+
+enum
+{
+    FrameIndex = 0x3,
+    FrameFresh = 0x4,
+};
+
+static void mergeInput(tic80_input* dst, const tic80_input* src)
+{
+    tic80_input prev = *dst;
+    *dst = *src;
+
+    // keep what happened since the last emulation tick
+    dst->gamepads.data |= prev.gamepads.data;
+    dst->mouse.left |= prev.mouse.left;
+    dst->mouse.middle |= prev.mouse.middle;
+    dst->mouse.right |= prev.mouse.right;
+    dst->mouse.scrollx = CLAMP(dst->mouse.scrollx + prev.mouse.scrollx, -32, 31);
+    dst->mouse.scrolly = CLAMP(dst->mouse.scrolly + prev.mouse.scrolly, -32, 31);
+
+    if(dst->mouse.relative)
+    {
+        dst->mouse.rx = CLAMP(dst->mouse.rx + prev.mouse.rx, INT8_MIN, INT8_MAX);
+        dst->mouse.ry = CLAMP(dst->mouse.ry + prev.mouse.ry, INT8_MIN, INT8_MAX);
+    }
+
+    for(s32 i = 0; i < TIC80_KEY_BUFFER && prev.keyboard.keys[i]; i++)
+    {
+        s32 k = 0;
+        while(k < TIC80_KEY_BUFFER && dst->keyboard.keys[k] && dst->keyboard.keys[k] != prev.keyboard.keys[i])
+            k++;
+
+        if(k < TIC80_KEY_BUFFER)
+            dst->keyboard.keys[k] = prev.keyboard.keys[i];
+    }
+}
+
+// render thread: hand the polled input and the text over to the emulation thread
+static void shareInput()
+{
+    LOCK_MUTEX(platform.thread.lock)
+    {
+        if(platform.thread.shared.taken)
+            platform.thread.shared.input = platform.input;
+        else
+            mergeInput(&platform.thread.shared.input, &platform.input);
+
+        if(platform.keyboard.text)
+            platform.thread.shared.text = platform.keyboard.text;
+
+        platform.thread.shared.taken = false;
+    }
 
     platform.keyboard.text = '\0';
 }
 
+// emulation thread
+static tic80_input takeInput()
+{
+    tic80_input input;
+
+    LOCK_MUTEX(platform.thread.lock)
+    {
+        input = platform.thread.shared.input;
+        platform.thread.text = platform.thread.shared.text;
+
+        if(!platform.thread.shared.taken)
+        {
+            // the next tick gets the same input unless a new one is polled:
+            // keep the held buttons and keys, drop the one-shot events
+            tic80_mouse* mouse = &platform.thread.shared.input.mouse;
+            mouse->scrollx = mouse->scrolly = 0;
+
+            if(mouse->relative)
+                mouse->rx = mouse->ry = 0;
+
+            platform.thread.shared.text = '\0';
+            platform.thread.shared.taken = true;
+        }
+    }
+
+    return input;
+}
+
+// emulation thread: run the studio calls requested by the render thread
+static void runRequests()
+{
+    char* load = NULL;
+    bool quit = false, rekeymap = false;
+    tic_layout keymap = tic_layout_unknown;
+
+    LOCK_MUTEX(platform.thread.lock)
+    {
+        load = platform.thread.shared.load;
+        quit = platform.thread.shared.quit;
+        rekeymap = platform.thread.shared.rekeymap;
+        keymap = platform.thread.shared.keymap;
+
+        platform.thread.shared.load = NULL;
+        platform.thread.shared.quit = platform.thread.shared.rekeymap = false;
+    }
+
+    if(rekeymap)
+        studio_keymapchanged(platform.studio, keymap);
+
+    if(load)
+    {
+        studio_load(platform.studio, load);
+        free(load);
+    }
+
+    if(quit)
+        studio_exit(platform.studio);
+}
+
+// render thread: apply the window changes requested by the studio
+static void applyWindowRequests()
+{
+    char title[TICNAME_MAX];
+    bool retitle = false, refullscreen = false, fullscreen = false, reconfig = false;
+    char* copy = NULL;
+    char* message = NULL;
+    char* messageTitle = NULL;
+
+    LOCK_MUTEX(platform.thread.lock)
+    {
+        if((retitle = platform.thread.shared.retitle))
+            memcpy(title, platform.thread.shared.title, sizeof title);
+
+        refullscreen = platform.thread.shared.refullscreen;
+        fullscreen = platform.thread.shared.fullscreen;
+        reconfig = platform.thread.shared.reconfig;
+        copy = platform.thread.shared.copy;
+
+        message = platform.thread.shared.message;
+        messageTitle = platform.thread.shared.messageTitle;
+
+        platform.thread.shared.retitle = platform.thread.shared.refullscreen = platform.thread.shared.reconfig = false;
+        platform.thread.shared.copy = NULL;
+        platform.thread.shared.message = platform.thread.shared.messageTitle = NULL;
+    }
+
+    if(retitle)
+        tic_sys_title(title);
+
+    if(refullscreen)
+        tic_sys_fullscreen_set(fullscreen);
+
+    if(reconfig)
+        tic_sys_update_config();
+
+    if(copy)
+    {
+        tic_sys_clipboard_set(copy);
+        SDL_free(copy);
+    }
+
+    if(message)
+    {
+        tic_sys_message(messageTitle, message);
+        SDL_free(message);
+        SDL_free(messageTitle);
+    }
+
+    {
+        bool isfullscreen = tic_sys_fullscreen_get();
+
+        LOCK_MUTEX(platform.thread.lock)
+        {
+            platform.thread.shared.isfullscreen = isfullscreen;
+        }
+    }
+}
+
+// emulation thread
+static void publishFrame()
+{
+    const tic_mem* tic = studio_mem(platform.studio);
+
+    s32 back = platform.thread.back;
+    memcpy(platform.thread.frames[back], tic->product.screen, sizeof platform.thread.frames[back]);
+    platform.thread.seq[back] = ++platform.thread.produced;
+    platform.thread.inputs[back] = tic->ram->input;
+
+    SDL_MemoryBarrierRelease();
+    platform.thread.back = SDL_AtomicSet(&platform.thread.middle, back | FrameFresh) & FrameIndex;
+    // the render thread is done reading the buffer we got back
+    SDL_MemoryBarrierAcquire();
+
+    SDL_SemPost(platform.thread.ready);
+}
+
+// render thread
+static bool takeFrame()
+{
+    if(!(SDL_AtomicGet(&platform.thread.middle) & FrameFresh))
+        return false;
+
+    SDL_MemoryBarrierRelease();
+    s32 front = platform.thread.front = SDL_AtomicSet(&platform.thread.middle, platform.thread.front) & FrameIndex;
+    // the frame written before the swap is seen in full
+    SDL_MemoryBarrierAcquire();
+
+    // queue depth: how many frames were produced since the last one we took,
+    // everything over one was overwritten in the middle buffer and never shown
+    {
+        u32 depth = platform.thread.seq[front] - platform.thread.stats.last;
+        platform.thread.stats.last = platform.thread.seq[front];
+
+        platform.thread.stats.presented++;
+        platform.thread.stats.dropped += depth - 1;
+        platform.thread.stats.depth = MAX(platform.thread.stats.depth, (s32)depth);
+    }
+
+    {
+        u64 now = SDL_GetPerformanceCounter();
+
+        if(platform.thread.stats.start == 0)
+            platform.thread.stats.start = now;
+
+        if(now - platform.thread.stats.start >= SDL_GetPerformanceFrequency() * 10)
+        {
+            if(studio_config(platform.studio)->options.fps)
+                SDL_Log("frames presented: %i, dropped: %i, max queue depth: %i\n",
+                    platform.thread.stats.presented, platform.thread.stats.dropped, platform.thread.stats.depth);
+
+            platform.thread.stats.start = now;
+            platform.thread.stats.presented = platform.thread.stats.dropped = platform.thread.stats.depth = 0;
+        }
+    }
+
+    return true;
+}
+
+static s32 emulationThread(void* data)
+{
+    platform.thread.id = SDL_ThreadID();
+
+    Scheduler sched = schedulerStart();
+
+    while (!studio_alive(platform.studio))
+    {
+        bool hidden = schedulerSkip(&sched);
+
+        runRequests();
+        emulate(takeInput(), hidden);
+
+        if(!hidden)
+            publishFrame();
+
+        schedulerWait(&sched, hidden);
+    }
+
+    // wake the render thread up to see the studio is done
+    SDL_SemPost(platform.thread.ready);
+
+    return 0;
+}
+
+static void loop()
+{
+    Scheduler sched = schedulerStart();
+
+    while (!studio_alive(platform.studio))
+    {
+        bool hidden = schedulerSkip(&sched);
+
+        if(studioTick(hidden) && !hidden)
+            gpuRender(studio_mem(platform.studio)->product.screen);
+
+        schedulerWait(&sched, hidden);
+    }
+}
+
+static void threadedLoop()
+{
+    platform.thread.lock = SDL_CreateMutex();
+    platform.thread.ready = SDL_CreateSemaphore(0);
+    platform.thread.shared.taken = true;
+    platform.thread.shared.isfullscreen = tic_sys_fullscreen_get();
+    platform.thread.back = 0;
+    platform.thread.front = 1;
+    SDL_AtomicSet(&platform.thread.middle, 2);
+
+    platform.thread.handle = SDL_CreateThread(emulationThread, "tic80 emulation", NULL);
+
+    if(!platform.thread.handle)
+    {
+        SDL_Log("Unable to start the emulation thread: %s, running on one thread\n", SDL_GetError());
+
+        SDL_DestroySemaphore(platform.thread.ready);
+        SDL_DestroyMutex(platform.thread.lock);
+
+        loop();
+        return;
+    }
+
+    updateClipboard();
+
+    while (!studio_alive(platform.studio))
+    {
+        pollEvents();
+        shareInput();
+        applyWindowRequests();
+
+        // present the latest frame, vsync and driver stalls block only this thread
+        if(takeFrame())
+            gpuRender(platform.thread.frames[platform.thread.front]);
+        else
+            SDL_SemWaitTimeout(platform.thread.ready, 1000 / TIC80_FRAMERATE);
+    }
+
+    SDL_WaitThread(platform.thread.handle, NULL);
+    platform.thread.handle = NULL;
+    platform.thread.id = 0;
+
+    // the studio may have said goodbye on its last tick
+    applyWindowRequests();
+
+    free(platform.thread.shared.load);
+    SDL_free(platform.thread.shared.copy);
+    SDL_free(platform.thread.shared.clipboard);
+
+    SDL_DestroySemaphore(platform.thread.ready);
+    SDL_DestroyMutex(platform.thread.lock);
+}
+
+#endif
+
 #if defined(__EMSCRIPTEN__)
 
+static void gpuTick()
+{
+    if(studioTick(false))
+        gpuRender(studio_mem(platform.studio)->product.screen);
+}
+
 static void emsGpuTick()
 {
     static double nextTick = -1.0;
@@ -2012,22 +2766,10 @@ static s32 start(s32 argc, char **argv, const char* folder)
 #if defined(__EMSCRIPTEN__)
             emscripten_set_main_loop(emsGpuTick, 0, 1);
 #else
-            {
-                const u64 Delta = SDL_GetPerformanceFrequency() / TIC80_FRAMERATE;
-                u64 nextTick = SDL_GetPerformanceCounter();
-
-                while (!studio_alive(platform.studio))
-                {
-                    gpuTick();
-
-                    s64 delay = (nextTick += Delta) - SDL_GetPerformanceCounter();
-
-                    if(delay > 0)
-                        SDL_Delay((u32)(delay * 1000 / SDL_GetPerformanceFrequency()));
-                    else if(delay < 0)
-                        nextTick = SDL_GetPerformanceCounter();
-                }
-            }
+            if(studio_config(platform.studio)->threaded)
+                threadedLoop();
+            else
+                loop();
 #endif
 
 #if defined(TOUCH_INPUT_SUPPORT)
@@ -24,6 +24,7 @@
 #include <stdio.h>
 #include <SDL.h>
 #include <tic80.h>
+#include "tools.h"
 
 #if defined(__APPLE__)
 # if MAC_OS_X_VERSION_MIN_REQUIRED < 1060
@@ -78,7 +79,7 @@ static void audioCallback(void* userdata, u8* stream, s32 len)
     SDL_UnlockMutex(state.mutex);
 }
 
-s32 runCart(void* cart, s32 size)
+s32 runCart(const void* cart, s32 size)
 {
     s32 output = 0;
 
@@ -87,7 +88,10 @@ s32 runCart(void* cart, s32 size)
 
     tic80* tic = tic80_create(TIC80_SAMPLERATE, TIC80_PIXEL_COLOR_RGBA8888);
     tic->callback.exit = onExit;
-    tic80_load(tic, cart, size);
+    tic80_load(tic, (void*)cart, size);
+
+    // the cart is parsed, the file isn't needed anymore
+    tic_tool_unmap(cart, size);
 
     if(!tic)
     {
@@ -223,7 +227,6 @@ s32 runCart(void* cart, s32 size)
         SDL_DestroyWindow(window);
     }
 
-    SDL_free(cart);
     return output;
 }
 
@@ -239,26 +242,12 @@ s32 main(s32 argc, char **argv)
         return 0;
     }
 
-    // Load the given file.
-    FILE* file = fopen(input, "rb");
-    if(!file)
-    {
-        fprintf(stderr, "Error: Could not load %s.\n\nUsage: %s <file>\n", input, argv[0]);
-        return 1;
-    }
-
-    // Load the file data.
-    fseek(file, 0, SEEK_END);
-    s32 size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-
-    // Read the data into usable memory.
-    void* cart = SDL_malloc(size);
-    if(cart) fread(cart, size, 1, file);
-    fclose(file);
+    // Map the given file.
+    s32 size = 0;
+    const void* cart = tic_tool_map(input, &size);
 
     if (!cart) {
-        fprintf(stderr, "Error reading %s.\n", input);
+        fprintf(stderr, "Error: Could not load %s.\n\nUsage: %s <file>\n", input, argv[0]);
         return 1;
     }
 
@@ -66,7 +66,7 @@ TIC80_API void tic80_load(tic80* tic, void* cart, s32 size)
 {
     tic_mem* mem = (tic_mem*)tic;
 
-    tic_cart_load(&mem->cart, cart, size);
+    tic_core_cart_share(mem, cart, size);
 
     const tic_script* script = tic_get_script(mem);
     if(script)
@@ -77,7 +77,7 @@ TIC80_API void tic80_load(tic80* tic, void* cart, s32 size)
 #if defined(TIC_MODULE_EXT)
     else
     {
-        const char* tag = tic_tool_metatag(mem->cart.code.data, "script", NULL);
+        const char* tag = tic_tool_metatag(mem->cart->code.data, "script", NULL);
         char name[128];
         sprintf(name, "%s" TIC_MODULE_EXT, tag);
 
@@ -101,7 +101,9 @@ TIC80_API void tic80_load(tic80* tic, void* cart, s32 size)
 #endif
 }
 
-TIC80_API void tic80_tick(tic80* tic, tic80_input input, CounterCallback counter, FreqCallback freq)
+enum {BlitScreen, BlitSkip, BlitCached};
+
+static bool tick(tic80* tic, tic80_input input, CounterCallback counter, FreqCallback freq, const tic80_clock* clock, s32 blit)
 {
     tic_mem* mem = (tic_mem*)tic;
 
@@ -115,13 +117,45 @@ TIC80_API void tic80_tick(tic80* tic, tic80_input input, CounterCallback counter
         .data = tic,
         .start = 0,
         .counter = counter,
-        .freq = freq
+        .freq = freq,
+        .clock = clock ? *clock : (tic80_clock){TIC80_CLOCK_REAL},
     };
 
     tic_core_tick_start(mem);
     tic_core_tick(mem, &tickData);
     tic_core_tick_end(mem);
-    tic_core_blit(mem);
+
+    switch(blit)
+    {
+    case BlitSkip:
+        tic_core_blit_skip(mem);
+        return false;
+    case BlitCached:
+        return tic_core_blit_cached(mem);
+    default:
+        tic_core_blit(mem);
+        return true;
+    }
+}
+
+TIC80_API void tic80_tick(tic80* tic, tic80_input input, CounterCallback counter, FreqCallback freq)
+{
+    tick(tic, input, counter, freq, NULL, BlitScreen);
+}
+
+TIC80_API void tic80_tick_clock(tic80* tic, tic80_input input, CounterCallback counter, FreqCallback freq, const tic80_clock* clock)
+{
+    tick(tic, input, counter, freq, clock, BlitScreen);
+}
+
+TIC80_API void tic80_tick_hidden(tic80* tic, tic80_input input, CounterCallback counter, FreqCallback freq, const tic80_clock* clock)
+{
+    tick(tic, input, counter, freq, clock, BlitSkip);
+}
+
+TIC80_API bool tic80_tick_cached(tic80* tic, tic80_input input, CounterCallback counter, FreqCallback freq, const tic80_clock* clock)
+{
+    return tick(tic, input, counter, freq, clock, BlitCached);
 }
 
 TIC80_API void tic80_sound(tic80* tic)
@@ -130,6 +164,21 @@ TIC80_API void tic80_sound(tic80* tic)
     tic_core_synth_sound(mem);
 }
 
+TIC80_API s32 tic80_state_size(tic80* tic)
+{
+    return tic_core_state_size((tic_mem*)tic);
+}
+
+TIC80_API bool tic80_state_save(tic80* tic, void* buffer, s32 size)
+{
+    return tic_core_state_save((tic_mem*)tic, buffer, size);
+}
+
+TIC80_API bool tic80_state_load(tic80* tic, const void* buffer, s32 size)
+{
+    return tic_core_state_load((tic_mem*)tic, buffer, size);
+}
+
 TIC80_API void tic80_delete(tic80* tic)
 {
     tic_mem* mem = (tic_mem*)tic;
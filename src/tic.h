@@ -28,7 +28,15 @@
 
 #define TIC_VRAM_SIZE (16*1024) //16K
 #define TIC_RAM_SIZE (TIC_VRAM_SIZE+80*1024) //16K+80K
+#define TIC_RAM_HEADER_SIZE 64 // reserved in front of the RAM for the VM memory header
+#define TIC_WASM_PAGE_SIZE (64*1024)
 #define TIC_WASM_PAGE_COUNT 4 // 256K
+#if !defined(TIC_WASM_MAX_PAGE_COUNT)
+#define TIC_WASM_MAX_PAGE_COUNT 256 // 16M
+#endif
+#if !defined(TIC_VM_MEMORY_LIMIT)
+#define TIC_VM_MEMORY_LIMIT (64*1024*1024) // 64M
+#endif
 #define TIC_FONT_WIDTH 6
 #define TIC_FONT_HEIGHT 6
 #define TIC_ALTFONT_WIDTH 4
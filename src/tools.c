@@ -27,6 +27,17 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#if defined(_WIN32)
+#define TIC_MAP_WIN32
+#include <windows.h>
+#elif (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#define TIC_MAP_POSIX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 extern void tic_tool_poke4(void* addr, u32 index, u8 value);
 extern u8 tic_tool_peek4(const void* addr, u32 index);
 extern void tic_tool_poke2(void* addr, u32 index, u8 value);
@@ -86,6 +97,119 @@ u32 tic_nearest_color(const tic_rgb* palette, const tic_rgb* color, s32 count)
     return nearest;
 }
 
+// RGB space is split into 32x32x32 boxes, every box keeps the mask of the palette
+// colors that can be the nearest for some point inside, filled on first use
+#define NEAREST_BITS 5
+#define NEAREST_SHIFT (BITS_IN_BYTE - NEAREST_BITS)
+#define NEAREST_BOX (1 << NEAREST_SHIFT)
+#define NEAREST_READY (1u << 31)
+#define NEAREST_SINGLE (1u << 30)
+#define NEAREST_INDEX 24
+
+struct tic_nearest
+{
+    tic_rgb palette[TIC_PALETTE_SIZE];
+    s32 count;
+
+    // candidates mask | index << NEAREST_INDEX | NEAREST_SINGLE | NEAREST_READY
+    u32 boxes[1 << (NEAREST_BITS * 3)];
+};
+
+tic_nearest* tic_nearest_create(const tic_rgb* palette, s32 count)
+{
+    tic_nearest* nearest = NULL;
+
+    if(count > 0 && count <= TIC_PALETTE_SIZE && (nearest = calloc(1, sizeof(tic_nearest))))
+    {
+        memcpy(nearest->palette, palette, count * sizeof(tic_rgb));
+        nearest->count = count;
+    }
+
+    return nearest;
+}
+
+static inline s32 boxDistMin(s32 c, s32 lo)
+{
+    return c < lo ? lo - c : c > lo + NEAREST_BOX - 1 ? c - (lo + NEAREST_BOX - 1) : 0;
+}
+
+static inline s32 boxDistMax(s32 c, s32 lo)
+{
+    return MAX(abs(c - lo), abs(c - (lo + NEAREST_BOX - 1)));
+}
+
+static u32 nearestBox(const tic_nearest* nearest, const tic_rgb* color)
+{
+    s32 r = color->r & ~(NEAREST_BOX - 1);
+    s32 g = color->g & ~(NEAREST_BOX - 1);
+    s32 b = color->b & ~(NEAREST_BOX - 1);
+
+    u32 dmin[TIC_PALETTE_SIZE];
+    u32 limit = -1;
+
+    for(s32 i = 0; i < nearest->count; i++)
+    {
+        const tic_rgb* rgb = &nearest->palette[i];
+
+        s32 n[] = {boxDistMin(rgb->r, r), boxDistMin(rgb->g, g), boxDistMin(rgb->b, b)};
+        s32 x[] = {boxDistMax(rgb->r, r), boxDistMax(rgb->g, g), boxDistMax(rgb->b, b)};
+
+        dmin[i] = n[0] * n[0] + n[1] * n[1] + n[2] * n[2];
+        limit = MIN(limit, (u32)(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]));
+    }
+
+    // a color farther than the worst case of another one can't win anywhere in the box
+    u32 mask = 0, count = 0, index = 0;
+    for(s32 i = 0; i < nearest->count; i++)
+        if(dmin[i] <= limit)
+        {
+            mask |= 1u << i;
+            index = i;
+            count++;
+        }
+
+    return count == 1
+        ? NEAREST_READY | NEAREST_SINGLE | index << NEAREST_INDEX
+        : NEAREST_READY | mask;
+}
+
+u32 tic_nearest_find(tic_nearest* nearest, const tic_rgb* color)
+{
+    u32* box = &nearest->boxes[(color->r >> NEAREST_SHIFT) << (NEAREST_BITS * 2)
+        | (color->g >> NEAREST_SHIFT) << NEAREST_BITS
+        | (color->b >> NEAREST_SHIFT)];
+
+    if(!*box)
+        *box = nearestBox(nearest, color);
+
+    if(*box & NEAREST_SINGLE)
+        return (*box >> NEAREST_INDEX) & (TIC_PALETTE_SIZE - 1);
+
+    u32 min = -1, mask = *box;
+    s32 found = 0;
+
+    for(s32 i = 0; i < nearest->count; i++)
+        if(mask & (1u << i))
+        {
+            const tic_rgb* rgb = &nearest->palette[i];
+            s32 d[] = {color->r - rgb->r, color->g - rgb->g, color->b - rgb->b};
+            u32 dst = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+
+            if (dst < min)
+            {
+                min = dst;
+                found = i;
+            }
+        }
+
+    return found;
+}
+
+void tic_nearest_close(tic_nearest* nearest)
+{
+    free(nearest);
+}
+
 tic_blitpal tic_tool_palette_blit(const tic_palette* srcpal, tic80_pixel_color_format fmt)
 {
     tic_blitpal pal;
@@ -171,35 +295,50 @@ bool tic_tool_noise(const tic_waveform* wave)
     return FLAT4(wave->data) && *wave->data % 0xff == 0;
 }
 
+static const char HexDigits[] = "0123456789abcdef";
+
 void tic_tool_buf2str(const void* data, s32 size, char* str, bool flip)
 {
-    for(s32 i = 0; i < size; i++, str += 2)
+    for(const u8 *ptr = data, *end = ptr + size; ptr < end; ptr++, str += 2)
     {
-        sprintf(str, "%02x", ((u8*)data)[i]);
-        if(flip) SWAP(str[0], str[1], char);
+        str[flip ? 1 : 0] = HexDigits[*ptr >> 4];
+        str[flip ? 0 : 1] = HexDigits[*ptr & 0xf];
     }
+
+    *str = '\0';
 }
 
+// hex digit values, everything else is 0
+static const u8 HexValues[256] =
+{
+    ['0'] = 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+    ['a'] = 10, 11, 12, 13, 14, 15,
+    ['A'] = 10, 11, 12, 13, 14, 15,
+};
+
 void tic_tool_str2buf(const char* str, s32 size, void* buf, bool flip)
 {
-    char val[] = "0x00";
-    const char* ptr = str;
+    const u8* ptr = (const u8*)str;
+    u8* out = buf;
 
-    for(s32 i = 0; i < size/2; i++)
-    {
-        if(flip)
-        {
-            val[3] = *ptr++;
-            val[2] = *ptr++;
-        }
-        else
-        {
-            val[2] = *ptr++;
-            val[3] = *ptr++;
-        }
+    for(s32 i = 0; i < size/2; i++, ptr += 2)
+        out[i] = flip
+            ? HexValues[ptr[1]] << 4 | HexValues[ptr[0]]
+            : HexValues[ptr[0]] << 4 | HexValues[ptr[1]];
+}
 
-        ((u8*)buf)[i] = (u8)strtol(val, NULL, 16);
+// 64-bit FNV-1a, pass TIC_HASH_SEED or the result of a previous call as seed
+u64 tic_tool_hash(const void* data, s32 size, u64 seed)
+{
+    u64 hash = seed;
+
+    for(const u8 *ptr = data, *end = ptr + size; ptr < end; ptr++)
+    {
+        hash ^= *ptr;
+        hash *= 0x100000001b3ull;
     }
+
+    return hash;
 }
 
 const char* tic_tool_metatag(const char* code, const char* tag, const char* comment)
@@ -238,4 +377,94 @@ const char* tic_tool_metatag(const char* code, const char* tag, const char* comm
     }
 
     return value;
-}
\ No newline at end of file
+}
+
+const void* tic_tool_map(const char* path, s32* size)
+{
+    void* data = NULL;
+
+#if defined(TIC_MAP_WIN32)
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if(file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER fileSize;
+
+        if(GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 && fileSize.QuadPart < INT32_MAX)
+        {
+            HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+            if(mapping)
+            {
+                // the view keeps the mapping alive
+                if((data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)))
+                    *size = (s32)fileSize.QuadPart;
+
+                CloseHandle(mapping);
+            }
+        }
+
+        CloseHandle(file);
+    }
+
+#elif defined(TIC_MAP_POSIX)
+
+    s32 fd = open(path, O_RDONLY);
+
+    if(fd >= 0)
+    {
+        struct stat st;
+
+        if(fstat(fd, &st) == 0 && st.st_size > 0 && st.st_size < INT32_MAX)
+        {
+            data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+            if(data == MAP_FAILED)
+                data = NULL;
+            else
+                *size = (s32)st.st_size;
+        }
+
+        close(fd);
+    }
+
+#else
+
+    FILE* file = fopen(path, "rb");
+
+    if(file)
+    {
+        fseek(file, 0, SEEK_END);
+        s32 fileSize = ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        if(fileSize > 0 && (data = malloc(fileSize)))
+        {
+            if(fread(data, fileSize, 1, file))
+                *size = fileSize;
+            else
+            {
+                free(data);
+                data = NULL;
+            }
+        }
+
+        fclose(file);
+    }
+
+#endif
+
+    return data;
+}
+
+void tic_tool_unmap(const void* data, s32 size)
+{
+#if defined(TIC_MAP_WIN32)
+    UnmapViewOfFile(data);
+#elif defined(TIC_MAP_POSIX)
+    munmap((void*)data, size);
+#else
+    free((void*)data);
+#endif
+}
@@ -101,6 +101,24 @@ void    tic_tool_str2buf(const char* str, s32 size, void* buf, bool flip);
 u32     tic_tool_zip(void* dest, s32 destSize, const void* source, s32 size);
 u32     tic_tool_unzip(void* dest, s32 bufSize, const void* source, s32 size);
 
+// deflate a zlib stream piece by piece, level is 0-9 like in zlib,
+// with no destination the output is only counted, close returns the compressed size or 0
+#define TIC_ZIP_FAST 1
+#define TIC_ZIP_BEST 9
+typedef struct tic_zip tic_zip;
+tic_zip*    tic_tool_zip_open(void* dest, s32 size, s32 level);
+bool        tic_tool_zip_write(tic_zip* zip, const void* source, s32 size);
+s32         tic_tool_zip_close(tic_zip* zip);
+
+// inflate a zlib stream piece by piece, read returns 0 at the end or on error
+typedef struct tic_unzip tic_unzip;
+tic_unzip*  tic_tool_unzip_open(const void* source, s32 size);
+s32         tic_tool_unzip_read(tic_unzip* unzip, void* dest, s32 size);
+void        tic_tool_unzip_close(tic_unzip* unzip);
+
+u64     tic_tool_hash(const void* data, s32 size, u64 seed);
+#define TIC_HASH_SEED 0xcbf29ce484222325ull
+
 bool    tic_tool_empty(const void* buffer, s32 size);
 #define EMPTY(BUFFER) (tic_tool_empty((BUFFER), sizeof (BUFFER)))
 
@@ -110,4 +128,15 @@ bool    tic_tool_flat4(const void* buffer, s32 size);
 bool    tic_tool_noise(const tic_waveform* wave);
 u32     tic_nearest_color(const tic_rgb* palette, const tic_rgb* color, s32 count);
 
+// same result as tic_nearest_color, for converting whole images to one palette of up to 16 colors
+typedef struct tic_nearest tic_nearest;
+tic_nearest*    tic_nearest_create(const tic_rgb* palette, s32 count);
+u32             tic_nearest_find(tic_nearest* nearest, const tic_rgb* color);
+void            tic_nearest_close(tic_nearest* nearest);
+
 const char* tic_tool_metatag(const char* code, const char* tag, const char* comment);
+
+// read-only view of a whole file, mapped where the platform can do it so every
+// instance loading the same cart shares the pages, NULL if the file can't be read
+const void* tic_tool_map(const char* path, s32* size);
+void        tic_tool_unmap(const void* data, s32 size);
@@ -23,6 +23,7 @@
 #include "tools.h"
 
 #include <zlib.h>
+#include <stdlib.h>
 
 u32 tic_tool_zip(void* dest, s32 destSize, const void* source, s32 size)
 {
@@ -35,3 +36,123 @@ u32 tic_tool_unzip(void* dest, s32 destSize, const void* source, s32 size)
     unsigned long destSizeLong = destSize;
     return uncompress(dest, &destSizeLong, source, size) == Z_OK ? destSizeLong : 0;
 }
+
+struct tic_zip
+{
+    z_stream stream;
+    bool count;
+    bool error;
+    u8 scratch[4096];
+};
+
+tic_zip* tic_tool_zip_open(void* dest, s32 size, s32 level)
+{
+    tic_zip* zip = calloc(1, sizeof(tic_zip));
+
+    if(zip)
+    {
+        zip->count = dest == NULL;
+        zip->stream.next_out = dest;
+        zip->stream.avail_out = size;
+
+        if(deflateInit(&zip->stream, level) != Z_OK)
+        {
+            free(zip);
+            return NULL;
+        }
+    }
+
+    return zip;
+}
+
+static s32 zipStep(tic_zip* zip, s32 flush)
+{
+    if(zip->count)
+    {
+        zip->stream.next_out = zip->scratch;
+        zip->stream.avail_out = sizeof zip->scratch;
+    }
+
+    s32 res = deflate(&zip->stream, flush);
+
+    // the destination is full
+    if(res == Z_BUF_ERROR || (!zip->count && zip->stream.avail_out == 0 && res != Z_STREAM_END))
+        res = Z_BUF_ERROR;
+
+    if(res != Z_OK && res != Z_STREAM_END)
+        zip->error = true;
+
+    return res;
+}
+
+bool tic_tool_zip_write(tic_zip* zip, const void* source, s32 size)
+{
+    zip->stream.next_in = (Bytef*)source;
+    zip->stream.avail_in = size;
+
+    while(!zip->error && zip->stream.avail_in)
+        zipStep(zip, Z_NO_FLUSH);
+
+    return !zip->error;
+}
+
+s32 tic_tool_zip_close(tic_zip* zip)
+{
+    while(!zip->error && zipStep(zip, Z_FINISH) != Z_STREAM_END);
+
+    s32 size = zip->error ? 0 : zip->stream.total_out;
+
+    deflateEnd(&zip->stream);
+    free(zip);
+
+    return size;
+}
+
+struct tic_unzip
+{
+    z_stream stream;
+    bool done;
+};
+
+tic_unzip* tic_tool_unzip_open(const void* source, s32 size)
+{
+    tic_unzip* unzip = calloc(1, sizeof(tic_unzip));
+
+    if(unzip)
+    {
+        unzip->stream.next_in = (Bytef*)source;
+        unzip->stream.avail_in = size;
+
+        if(inflateInit(&unzip->stream) != Z_OK)
+        {
+            free(unzip);
+            return NULL;
+        }
+    }
+
+    return unzip;
+}
+
+s32 tic_tool_unzip_read(tic_unzip* unzip, void* dest, s32 size)
+{
+    if(unzip->done)
+        return 0;
+
+    unzip->stream.next_out = dest;
+    unzip->stream.avail_out = size;
+
+    s32 res = inflate(&unzip->stream, Z_SYNC_FLUSH);
+
+    if(res != Z_OK)
+        unzip->done = true;
+
+    return res == Z_OK || res == Z_STREAM_END
+        ? size - unzip->stream.avail_out
+        : 0;
+}
+
+void tic_tool_unzip_close(tic_unzip* unzip)
+{
+    inflateEnd(&unzip->stream);
+    free(unzip);
+}